@@ -3,46 +3,226 @@
 
 # include <memory>
 # include <mutex>
+# include <chrono>
+# include <algorithm>
+# include <iterator>
+# include <utility>
+# include <array>
+# include <span>
+# include <type_traits>
+# include <compare>
 # include <stdexcept>
+# include <cstddef>
 # include <cstdint>
+# include <cstring>
 
-template <typename T>
+# if defined(__linux__)
+#  include <system_error>
+#  include <cerrno>
+#  include <sys/eventfd.h>
+#  include <sys/uio.h>
+#  include <unistd.h>
+# endif
+
+# include "circular_buffer_common.hpp"
+# include "circular_buffer_simd.hpp"
+
+template <typename T,
+          full_policy Policy = full_policy::overwrite,
+          typename Lock = std::mutex,
+          typename Stats = null_stats>
 class array_circular_buffer
 {
 public :
+    using segments = std::array<std::span<T>, 2>;
+
+    // Random-access iterator over the stored elements, oldest first.
+    template <bool Const>
+    class basic_iterator
+    {
+    public :
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const, const T*, T*>;
+        using reference = std::conditional_t<Const, const T&, T&>;
+
+        basic_iterator() noexcept :
+            _buffer(nullptr), _buffer_size(0), _start(0), _index(0)
+        { }
+
+        basic_iterator(pointer buffer, size_t buffer_size, size_t start,
+                       size_t index) noexcept :
+            _buffer(buffer),
+            _buffer_size(buffer_size),
+            _start(start),
+            _index(index)
+        { }
+
+        operator basic_iterator<true>() const noexcept requires (!Const)
+        {
+            return basic_iterator<true>(_buffer, _buffer_size, _start, _index);
+        }
+
+        reference operator*() const noexcept
+        {
+            return (*this)[0];
+        }
+
+        pointer operator->() const noexcept
+        {
+            return &(*this)[0];
+        }
+
+        reference operator[](difference_type n) const noexcept
+        {
+            size_t index = _start + _index + n;
+
+            if (index >= _buffer_size)
+            {
+                index -= _buffer_size;
+            }
+
+            return _buffer[index];
+        }
+
+        basic_iterator& operator++() noexcept
+        {
+            ++_index;
+
+            return *this;
+        }
+
+        basic_iterator operator++(int) noexcept
+        {
+            basic_iterator it = *this;
+
+            ++_index;
+
+            return it;
+        }
+
+        basic_iterator& operator--() noexcept
+        {
+            --_index;
+
+            return *this;
+        }
+
+        basic_iterator operator--(int) noexcept
+        {
+            basic_iterator it = *this;
+
+            --_index;
+
+            return it;
+        }
+
+        basic_iterator& operator+=(difference_type n) noexcept
+        {
+            _index += n;
+
+            return *this;
+        }
+
+        basic_iterator& operator-=(difference_type n) noexcept
+        {
+            _index -= n;
+
+            return *this;
+        }
+
+        friend basic_iterator operator+(basic_iterator it,
+                                        difference_type n) noexcept
+        {
+            return it += n;
+        }
+
+        friend basic_iterator operator+(difference_type n,
+                                        basic_iterator it) noexcept
+        {
+            return it += n;
+        }
+
+        friend basic_iterator operator-(basic_iterator it,
+                                        difference_type n) noexcept
+        {
+            return it -= n;
+        }
+
+        friend difference_type operator-(const basic_iterator& lhs,
+                                         const basic_iterator& rhs) noexcept
+        {
+            return static_cast<difference_type>(lhs._index)
+                - static_cast<difference_type>(rhs._index);
+        }
+
+        friend bool operator==(const basic_iterator& lhs,
+                               const basic_iterator& rhs) noexcept
+        {
+            return lhs._index == rhs._index;
+        }
+
+        friend auto operator<=>(const basic_iterator& lhs,
+                                const basic_iterator& rhs) noexcept
+        {
+            return lhs._index <=> rhs._index;
+        }
+
+    private :
+        pointer _buffer;
+        size_t _buffer_size;
+        size_t _start;
+        size_t _index;
+    };
+
+    using value_type = T;
+    using size_type = size_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using iterator = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
     array_circular_buffer() noexcept :
-        _buffer_size(0), _start(0), _end(0), _full(false)
+        _buffer_size(0), _buffer(nullptr), _start(0), _end(0), _full(false)
     { }
 
     array_circular_buffer(size_t buffer_size) :
         _buffer_size(buffer_size),
-        _buffer(std::make_unique<T[]>(buffer_size)),
+        _buffer(allocate(buffer_size)),
         _start(0),
         _end(0),
         _full(false)
     { }
 
-    array_circular_buffer(const array_circular_buffer& other)
+    array_circular_buffer(const array_circular_buffer& other) :
+        array_circular_buffer()
     {
-        std::lock_guard<std::recursive_mutex> lock(other._mutex);
+        std::lock_guard<Lock> lock(other._mutex);
 
         this->acb_copy(other);
     }
 
-    array_circular_buffer(array_circular_buffer&& other)
+    array_circular_buffer(array_circular_buffer&& other) :
+        array_circular_buffer()
     {
-        std::lock_guard<std::recursive_mutex> lock(other._mutex);
+        std::lock_guard<Lock> lock(other._mutex);
 
         this->acb_move(std::move(other));
     }
 
-    array_circular_buffer& operator=(const array_circular_buffer& other)
+    ~array_circular_buffer()
     {
-        std::lock_guard<std::recursive_mutex> lock(other._mutex);
-        std::lock_guard<std::recursive_mutex> lock2(_mutex);
+        this->release();
+        this->close_event_fd();
+    }
 
+    array_circular_buffer& operator=(const array_circular_buffer& other)
+    {
         if (this != &other)
         {
+            std::scoped_lock lock(other._mutex, _mutex);
+
             this->acb_copy(other);
         }
 
@@ -51,11 +231,10 @@ public :
 
     array_circular_buffer& operator=(array_circular_buffer&& other)
     {
-        std::lock_guard<std::recursive_mutex> lock(other._mutex);
-        std::lock_guard<std::recursive_mutex> lock2(_mutex);
-
         if (this != &other)
         {
+            std::scoped_lock lock(other._mutex, _mutex);
+
             this->acb_move(std::move(other));
         }
 
@@ -64,14 +243,21 @@ public :
 
     size_t buffer_size() const
     {
-        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        circular_buffer_read_lock<Lock> lock(_mutex);
 
         return _buffer_size;
     }
 
+    size_t size() const
+    {
+        circular_buffer_read_lock<Lock> lock(_mutex);
+
+        return this->_size();
+    }
+
     bool is_empty() const
     {
-        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        circular_buffer_read_lock<Lock> lock(_mutex);
 
         if (_full)
         {
@@ -83,86 +269,202 @@ public :
 
     bool is_full() const
     {
-        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        circular_buffer_read_lock<Lock> lock(_mutex);
 
         return _full;
     }
 
     void clear()
     {
-        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        std::lock_guard<Lock> lock(_mutex);
+
+        this->destroy_all();
 
         _start = 0;
         _end = 0;
         _full = false;
+
+        this->notify_resized();
     }
 
+    // Relocates the stored elements, oldest first, to the start of a new
+    // storage; when shrinking, only the newest buffer_size elements are kept.
     void resize(size_t buffer_size)
     {
-        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        std::lock_guard<Lock> lock(_mutex);
 
         if (buffer_size == _buffer_size)
         {
             return;
         }
 
-        if (buffer_size == 0)
+        const size_t size = this->_size();
+        const size_t kept = std::min(size, buffer_size);
+        T* buffer = allocate(buffer_size);
+        size_t start = _start + size - kept;
+
+        if (start >= _buffer_size)
         {
-            *this = array_circular_buffer();
+            start -= _buffer_size;
         }
-        else if (buffer_size > _buffer_size && _buffer_size == 0)
+
+        auto segments = this->make_segments(start, kept);
+
+        if constexpr (std::is_trivially_copyable_v<T>)
         {
-            *this = array_circular_buffer(buffer_size);
+            for (size_t n = 0, index = 0; n < segments.size(); ++n)
+            {
+                if (!segments[n].empty())
+                {
+                    std::memcpy(buffer + index, segments[n].data(),
+                                segments[n].size_bytes());
+                    index += segments[n].size();
+                }
+            }
         }
         else
         {
-            uint32_t n = 0;
+            T* end = buffer;
 
-            if (_start < buffer_size)
+            try
             {
-                n = _start;
+                end = std::uninitialized_move(segments[0].begin(),
+                                              segments[0].end(), buffer);
+                std::uninitialized_move(segments[1].begin(),
+                                        segments[1].end(), end);
             }
-            else
+            catch (...)
             {
-                while (n < _start)
-                {
-                    ++n;
-                }
+                std::destroy(buffer, end);
+                std::allocator<T>().deallocate(buffer, buffer_size);
+                throw;
             }
+        }
 
-            auto acb_old = std::move(*this);
+        this->release();
 
-            _buffer_size = buffer_size;
-            _buffer = std::make_unique<T[]>(buffer_size);
-            _start = n % buffer_size;
-            _end = _start;
+        _buffer_size = buffer_size;
+        _buffer = buffer;
+        _start = 0;
+        _end = kept < buffer_size ? kept : 0;
+        _full = buffer_size > 0 && kept == buffer_size;
 
-            while (!acb_old.is_empty())
-            {
-                this->add(acb_old.get());
-            }
-        }
+        this->notify_resized();
     }
 
     array_circular_buffer& add(const T& value)
     {
-        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        return this->_add(value);
+    }
 
-        if (_buffer_size == 0)
+    array_circular_buffer& add(T&& value)
+    {
+        return this->_add(std::move(value));
+    }
+
+    bool try_add(const T& value)
+    {
+        return this->_try_add(value);
+    }
+
+    bool try_add(T&& value)
+    {
+        return this->_try_add(std::move(value));
+    }
+
+    T get()
+    {
+        std::lock_guard<Lock> lock(_mutex);
+
+        if (this->_is_empty())
         {
-            throw std::out_of_range(
-                      "circular buffer doesn't have space memory to store");
+            throw std::out_of_range("circular buffer is empty");
         }
 
-        _buffer[_end++] = value;
-        this->post_add();
+        return this->_get();
+    }
 
-        return *this;
+    bool try_get(T& value)
+    {
+        std::unique_lock<Lock> lock(_mutex, std::try_to_lock);
+
+        if (!lock.owns_lock())
+        {
+            _stats.on_try_get_contended();
+
+            return false;
+        }
+
+        if (this->_is_empty())
+        {
+            _stats.on_try_get_empty();
+
+            return false;
+        }
+
+        value = this->_get();
+
+        return true;
     }
 
-    array_circular_buffer& add(T&& value)
+    T wait_get()
+    {
+        static_assert(circular_buffer_can_block<Lock>,
+                      "blocking operations need a real lock");
+
+        std::unique_lock<Lock> lock(_mutex);
+
+        _waiters.wait_not_empty(lock, [this]() { return !this->_is_empty(); });
+
+        return this->_get();
+    }
+
+    template <typename Rep, typename Period>
+    bool wait_get_for(T& value,
+                      const std::chrono::duration<Rep, Period>& timeout)
+    {
+        static_assert(circular_buffer_can_block<Lock>,
+                      "blocking operations need a real lock");
+
+        std::unique_lock<Lock> lock(_mutex);
+
+        bool ready = _waiters.wait_not_empty_for(lock, timeout, [this]()
+        {
+            return !this->_is_empty();
+        });
+
+        if (!ready)
+        {
+            return false;
+        }
+
+        value = this->_get();
+
+        return true;
+    }
+
+    array_circular_buffer& wait_add(const T& value)
+    {
+        return this->_wait_add(value);
+    }
+
+    array_circular_buffer& wait_add(T&& value)
+    {
+        return this->_wait_add(std::move(value));
+    }
+
+    // Adds all the values under a single lock, copying them in at most two
+    // contiguous segments. When there isn't enough room, the overwrite policy
+    // only keeps the last buffer_size() values, the reject policy adds none
+    // of them and the block policy waits for room as many times as needed.
+    array_circular_buffer& add_range(std::span<const T> values)
     {
-        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        std::unique_lock<Lock> lock(_mutex);
+
+        if (values.empty())
+        {
+            return *this;
+        }
 
         if (_buffer_size == 0)
         {
@@ -170,102 +472,956 @@ public :
                       "circular buffer doesn't have space memory to store");
         }
 
-        _buffer[_end++] = std::move(value);
-        this->post_add();
+        if constexpr (Policy == full_policy::reject)
+        {
+            if (values.size() > _buffer_size - this->_size())
+            {
+                throw std::out_of_range("circular buffer is full");
+            }
+        }
+        else if constexpr (Policy == full_policy::block)
+        {
+            while (values.size() > _buffer_size - this->_size())
+            {
+                const size_t count = _buffer_size - this->_size();
+
+                this->append(values.first(count));
+                this->notify_added(count);
+                values = values.subspan(count);
+                this->wait_not_full(lock);
+            }
+        }
+
+        this->append(values);
+        this->notify_added(values.size());
 
         return *this;
     }
 
-    T get()
+    template <typename InputIt>
+    array_circular_buffer& add_range(InputIt first, InputIt last)
+    {
+        if constexpr (std::contiguous_iterator<InputIt>
+                      && std::is_same_v<std::iter_value_t<InputIt>, T>)
+        {
+            return this->add_range(
+                       std::span<const T>(std::to_address(first),
+                                          std::to_address(last)));
+        }
+        else
+        {
+            std::unique_lock<Lock> lock(_mutex);
+            size_t count = 0;
+
+            if (first != last && _buffer_size == 0)
+            {
+                throw std::out_of_range(
+                          "circular buffer doesn't have space memory to store");
+            }
+
+            if constexpr (Policy == full_policy::reject)
+            {
+                static_assert(std::forward_iterator<InputIt>,
+                              "reject policy needs to know the range size");
+
+                if (static_cast<size_t>(std::distance(first, last))
+                    > _buffer_size - this->_size())
+                {
+                    throw std::out_of_range("circular buffer is full");
+                }
+            }
+
+            for (; first != last; ++first, ++count)
+            {
+                if constexpr (Policy == full_policy::block)
+                {
+                    if (_full)
+                    {
+                        this->notify_added(std::exchange(count, 0));
+                        this->wait_not_full(lock);
+                    }
+                }
+
+                this->push(*first);
+            }
+
+            this->notify_added(count);
+
+            return *this;
+        }
+    }
+
+    // Moves up to values.size() of the oldest elements into values under a
+    // single lock and returns how many were retrieved.
+    size_t get_n(std::span<T> values)
     {
-        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        std::lock_guard<Lock> lock(_mutex);
+
+        const size_t count = std::min(values.size(), this->_size());
 
-        if (this->is_empty())
+        if (count == 0)
         {
-            throw std::out_of_range("circular buffer is empty");
+            return 0;
         }
 
-        return this->_get();
+        const size_t first = std::min(count, _buffer_size - _start);
+
+        this->move_from_buffer(_start, values.first(first));
+        this->move_from_buffer(0, values.subspan(first, count - first));
+
+        this->post_get(count);
+
+        return count;
     }
 
-    bool try_get(T& value)
+    template <typename OutputIt>
+    size_t get_n(OutputIt out, size_t n)
     {
-        std::unique_lock<std::recursive_mutex> lock(_mutex, std::try_to_lock);
+        std::lock_guard<Lock> lock(_mutex);
 
-        if (!lock.owns_lock())
+        const size_t count = std::min(n, this->_size());
+
+        if (count == 0)
         {
-            return false;
+            return 0;
         }
 
-        if (this->is_empty())
+        size_t start = _start;
+
+        for (size_t i = 0; i < count; ++i, ++out)
         {
-            return false;
+            *out = std::move(_buffer[start]);
+
+            if (++start == _buffer_size)
+            {
+                start = 0;
+            }
         }
 
-        value = this->_get();
+        this->post_get(count);
 
-        return true;
+        return count;
     }
 
-private :
-    size_t _buffer_size;
-    std::unique_ptr<T[]> _buffer;
-    uint32_t _start;
-    uint32_t _end;
-    bool _full;
-    mutable std::recursive_mutex _mutex;
+    // Zero-copy access to the storage : peek exposes the stored elements,
+    // oldest first, and consume releases the n oldest ones; prepare exposes
+    // up to n free slots following the newest element and commit publishes
+    // the n first of them. The spans stay valid until the matching
+    // consume/commit as long as no other call modifies the buffer meanwhile.
+    // Free slots hold no object, hence prepare/commit are limited to
+    // trivially copyable types.
+    segments peek()
+    {
+        std::lock_guard<Lock> lock(_mutex);
 
-    void acb_copy(const array_circular_buffer& other)
+        return this->make_segments(_start, this->_size());
+    }
+
+    void consume(size_t n)
     {
-        _buffer_size = other._buffer_size;
-        _buffer.reset(new T[other._buffer_size]);
+        std::lock_guard<Lock> lock(_mutex);
 
-        for (uint32_t n = 0; n < other._buffer_size; ++n)
+        if (n > this->_size())
         {
-            _buffer[n] = other._buffer[n];
+            throw std::out_of_range(
+                      "circular buffer doesn't have enough elements");
         }
 
-        _start = other._start;
-        _end = other._end;
-        _full = other._full;
+        if (n > 0)
+        {
+            this->post_get(n);
+        }
     }
 
-    void acb_move(array_circular_buffer&& other)
+    segments prepare(size_t n) requires std::is_trivially_copyable_v<T>
     {
-        _buffer_size = std::exchange(other._buffer_size, 0);
-        _buffer = std::exchange(other._buffer, nullptr);
-        _start = std::exchange(other._start, 0);
-        _end = std::exchange(other._end, 0);
-        _full = std::exchange(other._full, false);
+        std::lock_guard<Lock> lock(_mutex);
+
+        return this->make_segments(
+                   _end, std::min(n, _buffer_size - this->_size()));
     }
 
-    void post_add() noexcept
+    void commit(size_t n) requires std::is_trivially_copyable_v<T>
     {
-        _end %= _buffer_size;
+        std::lock_guard<Lock> lock(_mutex);
 
-        if (_end == _start)
+        if (n > _buffer_size - this->_size())
         {
-            _full = true;
+            throw std::out_of_range("circular buffer doesn't have enough space");
         }
-        else if (_full)
+
+        if (n > 0)
         {
-            ++_start;
-            _start %= _buffer_size;
+            this->post_commit(n);
         }
     }
 
-    T _get()
+# if defined(__linux__)
+    // Byte buffers only : reads up to max bytes from fd into the free slots,
+    // or writes up to max of the oldest bytes to fd, with a single readv or
+    // writev over the one or two segments involved, then publishes or
+    // releases the bytes actually transferred. The lock is held during the
+    // call, which is meant for non-blocking descriptors. Returns the result
+    // of readv/writev; no call is made, and 0 is returned, when there is no
+    // room or nothing to write.
+    ssize_t read_from_fd(int fd, size_t max = SIZE_MAX)
+        requires (sizeof(T) == 1 && std::is_trivially_copyable_v<T>)
     {
-        T value = std::move(_buffer[_start++]);
+        std::lock_guard<Lock> lock(_mutex);
 
-        _start %= _buffer_size;
+        iovec iov[2];
+        const int count = this->make_iovec(
+                              iov, _end,
+                              std::min(max, _buffer_size - this->_size()));
 
-        if (_full)
+        if (count == 0)
         {
-            _full = false;
+            return 0;
         }
 
-        return value;
+        const ssize_t n = readv(fd, iov, count);
+
+        if (n > 0)
+        {
+            this->post_commit(n);
+        }
+
+        return n;
+    }
+
+    ssize_t write_to_fd(int fd, size_t max = SIZE_MAX)
+        requires (sizeof(T) == 1 && std::is_trivially_copyable_v<T>)
+    {
+        std::lock_guard<Lock> lock(_mutex);
+
+        iovec iov[2];
+        const int count = this->make_iovec(iov, _start,
+                                           std::min(max, this->_size()));
+
+        if (count == 0)
+        {
+            return 0;
+        }
+
+        const ssize_t n = writev(fd, iov, count);
+
+        if (n > 0)
+        {
+            this->post_get(n);
+        }
+
+        return n;
+    }
+# endif
+
+    // Calls fn on up to n of the oldest elements, in place and under a single
+    // lock, then releases them all at once; returns how many were consumed.
+    // If fn throws, no element is consumed.
+    template <typename Fn>
+    size_t consume_up_to(size_t n, Fn&& fn)
+    {
+        return this->consume<false>(n, fn);
+    }
+
+    template <typename Fn>
+    size_t consume_all(Fn&& fn)
+    {
+        return this->consume<false>(SIZE_MAX, fn);
+    }
+
+    // Same as consume_up_to and consume_all, but fn is called with each non
+    // empty storage segment, as a std::span<T>, instead of each element.
+    template <typename Fn>
+    size_t consume_segments_up_to(size_t n, Fn&& fn)
+    {
+        return this->consume<true>(n, fn);
+    }
+
+    template <typename Fn>
+    size_t consume_segments(Fn&& fn)
+    {
+        return this->consume<true>(SIZE_MAX, fn);
+    }
+
+# if defined(__linux__)
+    // Returns a non-blocking eventfd, created on the first call, that becomes
+    // readable when the buffer goes from empty to non empty and, when
+    // notify_not_full is set, from full to not full, so that the buffer can
+    // be watched with epoll alongside sockets. Transitions are coalesced :
+    // a burst of adds on a non empty buffer writes nothing, hence a consumer
+    // should read the eventfd, then get until the buffer is empty. The
+    // overwrite policy may signal spuriously.
+    int event_fd(bool notify_not_full = false)
+    {
+        std::lock_guard<Lock> lock(_mutex);
+
+        if (_event_fd == -1)
+        {
+            _event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+            if (_event_fd == -1)
+            {
+                throw std::system_error(errno, std::generic_category(),
+                                        "eventfd");
+            }
+        }
+
+        _event_not_full = notify_not_full;
+
+        return _event_fd;
+    }
+# endif
+
+    // Counters of the Stats policy, read without taking the lock.
+    circular_buffer_stats snapshot() const noexcept
+    {
+        return _stats.snapshot();
+    }
+
+    // Element access and iterators, relative to the oldest element. They
+    // don't lock : like the spans returned by peek, the references and
+    // iterators are only valid while no other call modifies the buffer.
+    T& operator[](size_t n) noexcept
+    {
+        return this->begin()[n];
+    }
+
+    const T& operator[](size_t n) const noexcept
+    {
+        return this->begin()[n];
+    }
+
+    T& at(size_t n)
+    {
+        return this->_at(*this, n);
+    }
+
+    const T& at(size_t n) const
+    {
+        return this->_at(*this, n);
+    }
+
+    T& front()
+    {
+        return this->_at(*this, 0);
+    }
+
+    const T& front() const
+    {
+        return this->_at(*this, 0);
+    }
+
+    T& back()
+    {
+        return this->_back(*this);
+    }
+
+    const T& back() const
+    {
+        return this->_back(*this);
+    }
+
+    iterator begin() noexcept
+    {
+        return iterator(_buffer, _buffer_size, _start, 0);
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return const_iterator(_buffer, _buffer_size, _start, 0);
+    }
+
+    const_iterator cbegin() const noexcept
+    {
+        return this->begin();
+    }
+
+    iterator end() noexcept
+    {
+        return iterator(_buffer, _buffer_size, _start, this->_size());
+    }
+
+    const_iterator end() const noexcept
+    {
+        return const_iterator(_buffer, _buffer_size, _start, this->_size());
+    }
+
+    const_iterator cend() const noexcept
+    {
+        return this->end();
+    }
+
+    // Aggregates of the stored elements, computed in place over the storage
+    // segments with the kernels of circular_buffer_simd.hpp.
+    circular_buffer_sum_t<T> sum() const requires std::is_arithmetic_v<T>
+    {
+        circular_buffer_read_lock<Lock> lock(_mutex);
+
+        return this->_sum();
+    }
+
+    double mean() const requires std::is_arithmetic_v<T>
+    {
+        circular_buffer_read_lock<Lock> lock(_mutex);
+
+        if (this->_is_empty())
+        {
+            throw std::out_of_range("circular buffer is empty");
+        }
+
+        return static_cast<double>(this->_sum()) / this->_size();
+    }
+
+    T min() const requires std::is_arithmetic_v<T>
+    {
+        return this->extremum<false>();
+    }
+
+    T max() const requires std::is_arithmetic_v<T>
+    {
+        return this->extremum<true>();
+    }
+
+private :
+    // Only the slots between _start and _end hold constructed elements.
+    size_t _buffer_size;
+    T* _buffer;
+    uint32_t _start;
+    uint32_t _end;
+    bool _full;
+    mutable Lock _mutex;
+    [[no_unique_address]] Stats _stats;
+    [[no_unique_address]] circular_buffer_waiters<Lock> _waiters;
+    int _event_fd = -1;
+    bool _event_not_full = false;
+
+    static T* allocate(size_t buffer_size)
+    {
+        if (buffer_size == 0)
+        {
+            return nullptr;
+        }
+
+        return std::allocator<T>().allocate(buffer_size);
+    }
+
+    void destroy_all() noexcept
+    {
+        if constexpr (!std::is_trivially_destructible_v<T>)
+        {
+            size_t index = _start;
+
+            for (size_t n = this->_size(); n > 0; --n)
+            {
+                std::destroy_at(_buffer + index);
+
+                if (++index == _buffer_size)
+                {
+                    index = 0;
+                }
+            }
+        }
+    }
+
+    void release() noexcept
+    {
+        this->destroy_all();
+
+        if (_buffer != nullptr)
+        {
+            std::allocator<T>().deallocate(_buffer, _buffer_size);
+        }
+
+        _buffer_size = 0;
+        _buffer = nullptr;
+        _start = 0;
+        _end = 0;
+        _full = false;
+    }
+
+    void acb_copy(const array_circular_buffer& other)
+    {
+        this->release();
+
+        _buffer = allocate(other._buffer_size);
+        _buffer_size = other._buffer_size;
+        _start = other._start;
+        _end = other._start;
+
+        size_t index = other._start;
+
+        for (size_t n = other._size(); n > 0; --n)
+        {
+            this->push(other._buffer[index]);
+
+            if (++index == other._buffer_size)
+            {
+                index = 0;
+            }
+        }
+    }
+
+    void acb_move(array_circular_buffer&& other)
+    {
+        this->release();
+
+        _buffer_size = std::exchange(other._buffer_size, 0);
+        _buffer = std::exchange(other._buffer, nullptr);
+        _start = std::exchange(other._start, 0);
+        _end = std::exchange(other._end, 0);
+        _full = std::exchange(other._full, false);
+
+        this->close_event_fd();
+
+        _event_fd = std::exchange(other._event_fd, -1);
+        _event_not_full = std::exchange(other._event_not_full, false);
+    }
+
+    // Publishes the n slots following the newest element.
+    void post_commit(size_t n)
+    {
+        _end += n;
+
+        if (_end >= _buffer_size)
+        {
+            _end -= _buffer_size;
+        }
+
+        _full = _end == _start;
+
+        this->notify_added(n);
+    }
+
+# if defined(__linux__)
+    int make_iovec(iovec (&iov)[2], size_t index, size_t count) const noexcept
+    {
+        int n = 0;
+
+        for (std::span<T> segment : this->make_segments(index, count))
+        {
+            if (!segment.empty())
+            {
+                iov[n].iov_base = segment.data();
+                iov[n].iov_len = segment.size();
+                ++n;
+            }
+        }
+
+        return n;
+    }
+# endif
+
+    void close_event_fd() noexcept
+    {
+# if defined(__linux__)
+        if (_event_fd != -1)
+        {
+            close(_event_fd);
+        }
+# endif
+
+        _event_fd = -1;
+    }
+
+    void signal_event() noexcept
+    {
+# if defined(__linux__)
+        const uint64_t one = 1;
+
+        // Only fails when the counter would overflow : it is readable anyway.
+        [[maybe_unused]] ssize_t written = write(_event_fd, &one, sizeof(one));
+# endif
+    }
+
+    // Copies the values after the newest element; with the overwrite policy
+    // the oldest elements are replaced when there isn't enough room.
+    void append(std::span<const T> values)
+    {
+        if constexpr (std::is_trivially_copyable_v<T>)
+        {
+            const size_t size = this->_size();
+
+            if (size + values.size() > _buffer_size)
+            {
+                _stats.on_overwrite(size + values.size() - _buffer_size);
+            }
+
+            if (values.size() >= _buffer_size)
+            {
+                this->copy_to_buffer(0, values.last(_buffer_size));
+                _start = 0;
+                _end = 0;
+                _full = true;
+            }
+            else
+            {
+                const size_t count = values.size();
+                const size_t first = std::min(count, _buffer_size - _end);
+
+                this->copy_to_buffer(_end, values.first(first));
+                this->copy_to_buffer(0, values.subspan(first));
+
+                _end = (_end + count) % _buffer_size;
+
+                if (size + count >= _buffer_size)
+                {
+                    _start = _end;
+                    _full = true;
+                }
+            }
+        }
+        else
+        {
+            for (const T& value : values)
+            {
+                this->push(value);
+            }
+        }
+    }
+
+    // Constructs the value in the free slot at _end. Only the overwrite
+    // policy may push into a full buffer, assigning over the oldest element.
+    template <typename U>
+    void push(U&& value)
+    {
+        if constexpr (Policy == full_policy::overwrite)
+        {
+            if (_full)
+            {
+                _stats.on_overwrite(1);
+                _buffer[_end] = std::forward<U>(value);
+
+                if (++_end == _buffer_size)
+                {
+                    _end = 0;
+                }
+
+                _start = _end;
+
+                return;
+            }
+        }
+
+        std::construct_at(_buffer + _end, std::forward<U>(value));
+
+        if (++_end == _buffer_size)
+        {
+            _end = 0;
+        }
+
+        _full = _end == _start;
+    }
+
+    template <typename U>
+    array_circular_buffer& _add(U&& value)
+    {
+        std::unique_lock<Lock> lock(_mutex);
+
+        if (_buffer_size == 0)
+        {
+            throw std::out_of_range(
+                      "circular buffer doesn't have space memory to store");
+        }
+
+        if constexpr (Policy == full_policy::reject)
+        {
+            if (_full)
+            {
+                throw std::out_of_range("circular buffer is full");
+            }
+        }
+        else if constexpr (Policy == full_policy::block)
+        {
+            this->wait_not_full(lock);
+        }
+
+        this->push(std::forward<U>(value));
+        this->notify_added();
+
+        return *this;
+    }
+
+    template <typename U>
+    bool _try_add(U&& value)
+    {
+        std::unique_lock<Lock> lock(_mutex, std::try_to_lock);
+
+        if (!lock.owns_lock() || _buffer_size == 0)
+        {
+            return false;
+        }
+
+        if constexpr (Policy != full_policy::overwrite)
+        {
+            if (_full)
+            {
+                return false;
+            }
+        }
+
+        this->push(std::forward<U>(value));
+        this->notify_added();
+
+        return true;
+    }
+
+    T _get()
+    {
+        T value = std::move(_buffer[_start]);
+
+        this->post_get(1);
+
+        return value;
+    }
+
+    bool _is_empty() const noexcept
+    {
+        return !_full && _start == _end;
+    }
+
+    circular_buffer_sum_t<T> _sum() const noexcept
+    {
+        auto segments = this->make_segments(_start, this->_size());
+
+        return circular_buffer_sum<T>(segments[0])
+            + circular_buffer_sum<T>(segments[1]);
+    }
+
+    template <bool Max>
+    T extremum() const
+    {
+        circular_buffer_read_lock<Lock> lock(_mutex);
+
+        if (this->_is_empty())
+        {
+            throw std::out_of_range("circular buffer is empty");
+        }
+
+        auto segments = this->make_segments(_start, this->_size());
+        T result = circular_buffer_extremum<Max, T>(segments[0]);
+
+        if (!segments[1].empty())
+        {
+            const T other = circular_buffer_extremum<Max, T>(segments[1]);
+
+            result = (Max ? other > result : other < result) ? other : result;
+        }
+
+        return result;
+    }
+
+    template <typename Self>
+    static auto& _at(Self& self, size_t n)
+    {
+        circular_buffer_read_lock<Lock> lock(self._mutex);
+
+        if (n >= self._size())
+        {
+            if (self._is_empty())
+            {
+                throw std::out_of_range("circular buffer is empty");
+            }
+
+            throw std::out_of_range("circular buffer index out of range");
+        }
+
+        return self.begin()[n];
+    }
+
+    template <typename Self>
+    static auto& _back(Self& self)
+    {
+        circular_buffer_read_lock<Lock> lock(self._mutex);
+
+        if (self._is_empty())
+        {
+            throw std::out_of_range("circular buffer is empty");
+        }
+
+        return self.begin()[self._size() - 1];
+    }
+
+    size_t _size() const noexcept
+    {
+        if (_full)
+        {
+            return _buffer_size;
+        }
+
+        return _end >= _start ? _end - _start : _buffer_size - _start + _end;
+    }
+
+    segments make_segments(size_t index, size_t count) const noexcept
+    {
+        const size_t first = std::min(count, _buffer_size - index);
+
+        return { std::span<T>(_buffer + index, first),
+                 std::span<T>(_buffer, count - first) };
+    }
+
+    void copy_to_buffer(size_t index, std::span<const T> values)
+    {
+        if constexpr (std::is_trivially_copyable_v<T>)
+        {
+            if (!values.empty())
+            {
+                std::memcpy(&_buffer[index], values.data(),
+                            values.size_bytes());
+            }
+        }
+        else
+        {
+            std::copy(values.begin(), values.end(), &_buffer[index]);
+        }
+    }
+
+    void move_from_buffer(size_t index, std::span<T> values)
+    {
+        if constexpr (std::is_trivially_copyable_v<T>)
+        {
+            if (!values.empty())
+            {
+                std::memcpy(values.data(), &_buffer[index],
+                            values.size_bytes());
+            }
+        }
+        else
+        {
+            std::move(&_buffer[index], &_buffer[index] + values.size(),
+                      values.begin());
+        }
+    }
+
+    // Destroys the count oldest elements and releases their slots.
+    void post_get(size_t count) noexcept
+    {
+        if constexpr (!std::is_trivially_destructible_v<T>)
+        {
+            size_t index = _start;
+
+            for (size_t n = count; n > 0; --n)
+            {
+                std::destroy_at(_buffer + index);
+
+                if (++index == _buffer_size)
+                {
+                    index = 0;
+                }
+            }
+        }
+
+        _start += count;
+
+        if (_start >= _buffer_size)
+        {
+            _start -= _buffer_size;
+        }
+
+        _full = false;
+
+        _stats.on_get(count);
+        this->notify_removed(count);
+    }
+
+    template <bool Segments, typename Fn>
+    size_t consume(size_t n, Fn& fn)
+    {
+        std::lock_guard<Lock> lock(_mutex);
+
+        const size_t count = std::min(n, this->_size());
+
+        if (count == 0)
+        {
+            return 0;
+        }
+
+        for (std::span<T> segment : this->make_segments(_start, count))
+        {
+            if constexpr (Segments)
+            {
+                if (!segment.empty())
+                {
+                    fn(segment);
+                }
+            }
+            else
+            {
+                for (T& value : segment)
+                {
+                    fn(value);
+                }
+            }
+        }
+
+        this->post_get(count);
+
+        return count;
+    }
+
+    template <typename U>
+    array_circular_buffer& _wait_add(U&& value)
+    {
+        std::unique_lock<Lock> lock(_mutex);
+
+        if (_buffer_size == 0)
+        {
+            throw std::out_of_range(
+                      "circular buffer doesn't have space memory to store");
+        }
+
+        this->wait_not_full(lock);
+        this->push(std::forward<U>(value));
+        this->notify_added();
+
+        return *this;
+    }
+
+    void wait_not_full(std::unique_lock<Lock>& lock)
+    {
+        static_assert(circular_buffer_can_block<Lock>,
+                      "blocking operations need a real lock");
+
+        _waiters.wait_not_full(lock, [this]() { return !_full; });
+
+        // The buffer may have been resized to 0 while waiting.
+        if (_buffer_size == 0)
+        {
+            throw std::out_of_range(
+                      "circular buffer doesn't have space memory to store");
+        }
+    }
+
+    void notify_added(size_t count = 1)
+    {
+        _stats.on_add(count, this->_size());
+
+        // The buffer was empty if it holds no more than what was just added.
+        if (_event_fd != -1 && count > 0 && this->_size() <= count)
+        {
+            this->signal_event();
+        }
+
+        _waiters.notify_not_empty(count);
+    }
+
+    void notify_removed(size_t count = 1) noexcept
+    {
+        if (_event_not_full && this->_size() + count == _buffer_size)
+        {
+            this->signal_event();
+        }
+
+        _waiters.notify_not_full(count);
+    }
+
+    void notify_resized()
+    {
+        if (_event_not_full)
+        {
+            this->signal_event();
+        }
+
+        _waiters.notify_all_not_full();
     }
 };
 
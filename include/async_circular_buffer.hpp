@@ -0,0 +1,395 @@
+#ifndef ASYNC_CIRCULAR_BUFFER_HPP_
+# define ASYNC_CIRCULAR_BUFFER_HPP_
+
+# include <coroutine>
+# include <deque>
+# include <exception>
+# include <mutex>
+# include <optional>
+# include <utility>
+# include <cstddef>
+
+# include "circular_buffer_common.hpp"
+# include "array_circular_buffer.hpp"
+
+// Circular buffer for coroutines : co_await async_get() suspends the
+// coroutine while the buffer is empty and co_await async_add(value) while it
+// is full. There is no polling and no scheduler involved : the call that
+// makes progress possible (an add for a waiting getter, a get for a waiting
+// adder) hands the element over and resumes the waiting coroutine inline,
+// on its own thread, once the lock is released. Suspended coroutines must
+// be resumed before the buffer is destroyed. A buffer of size 0 is a
+// rendezvous : every add is handed directly to a getter.
+template <typename T, typename Lock = std::mutex>
+class async_circular_buffer
+{
+    struct waiter
+    {
+        std::coroutine_handle<> handle;
+        std::optional<T> value;
+        waiter* next = nullptr;
+    };
+
+    // FIFO of suspended coroutines, linked through their awaiters, which
+    // live in the coroutine frames.
+    struct waiter_queue
+    {
+        waiter* head = nullptr;
+        waiter* tail = nullptr;
+
+        bool empty() const noexcept
+        {
+            return head == nullptr;
+        }
+
+        void push(waiter* w) noexcept
+        {
+            (tail != nullptr ? tail->next : head) = w;
+            tail = w;
+        }
+
+        waiter* pop() noexcept
+        {
+            waiter* w = head;
+
+            head = w->next;
+
+            if (head == nullptr)
+            {
+                tail = nullptr;
+            }
+
+            return w;
+        }
+    };
+
+public :
+    class get_awaiter
+    {
+    public :
+        explicit get_awaiter(async_circular_buffer& buffer) noexcept :
+            _buffer(buffer)
+        { }
+
+        bool await_ready()
+        {
+            return _buffer.take(_waiter.value);
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle)
+        {
+            _waiter.handle = handle;
+
+            return _buffer.suspend_get(_waiter);
+        }
+
+        T await_resume()
+        {
+            return std::move(*_waiter.value);
+        }
+
+    private :
+        async_circular_buffer& _buffer;
+        waiter _waiter;
+    };
+
+    class add_awaiter
+    {
+    public :
+        add_awaiter(async_circular_buffer& buffer, T&& value) :
+            _buffer(buffer)
+        {
+            _waiter.value.emplace(std::move(value));
+        }
+
+        bool await_ready()
+        {
+            return _buffer.offer(_waiter.value);
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle)
+        {
+            _waiter.handle = handle;
+
+            return _buffer.suspend_add(_waiter);
+        }
+
+        void await_resume() noexcept
+        { }
+
+    private :
+        async_circular_buffer& _buffer;
+        waiter _waiter;
+    };
+
+    async_circular_buffer(size_t buffer_size) :
+        _buffer(buffer_size)
+    { }
+
+    async_circular_buffer(const async_circular_buffer&) = delete;
+    async_circular_buffer& operator=(const async_circular_buffer&) = delete;
+
+    size_t buffer_size() const
+    {
+        circular_buffer_read_lock<Lock> lock(_mutex);
+
+        return _buffer.buffer_size();
+    }
+
+    size_t size() const
+    {
+        circular_buffer_read_lock<Lock> lock(_mutex);
+
+        return _buffer.size();
+    }
+
+    bool is_empty() const
+    {
+        circular_buffer_read_lock<Lock> lock(_mutex);
+
+        return _buffer.is_empty();
+    }
+
+    get_awaiter async_get() noexcept
+    {
+        return get_awaiter(*this);
+    }
+
+    add_awaiter async_add(T value)
+    {
+        return add_awaiter(*this, std::move(value));
+    }
+
+    // Non-suspending versions, usable outside coroutines; they resume the
+    // coroutine they unblock, if any.
+    bool try_add(T value)
+    {
+        std::optional<T> slot(std::move(value));
+
+        return this->offer(slot);
+    }
+
+    bool try_get(T& value)
+    {
+        std::optional<T> slot;
+
+        if (!this->take(slot))
+        {
+            return false;
+        }
+
+        value = std::move(*slot);
+
+        return true;
+    }
+
+private :
+    array_circular_buffer<T, full_policy::reject, null_lock> _buffer;
+    waiter_queue _getters;
+    waiter_queue _adders;
+    mutable Lock _mutex;
+
+    // Only moves from value on success.
+    bool offer(std::optional<T>& value)
+    {
+        std::unique_lock<Lock> lock(_mutex);
+
+        return this->_try_add(value, lock);
+    }
+
+    bool take(std::optional<T>& value)
+    {
+        std::unique_lock<Lock> lock(_mutex);
+
+        return this->_try_get(value, lock);
+    }
+
+    // Returns false when the element could be added after all, in which case
+    // the coroutine goes on without suspending.
+    bool suspend_add(waiter& w)
+    {
+        std::unique_lock<Lock> lock(_mutex);
+
+        if (this->_try_add(w.value, lock))
+        {
+            return false;
+        }
+
+        _adders.push(&w);
+
+        return true;
+    }
+
+    bool suspend_get(waiter& w)
+    {
+        std::unique_lock<Lock> lock(_mutex);
+
+        if (this->_try_get(w.value, lock))
+        {
+            return false;
+        }
+
+        _getters.push(&w);
+
+        return true;
+    }
+
+    // Getters only wait while the buffer is empty, so a waiting getter takes
+    // the element directly.
+    bool _try_add(std::optional<T>& value, std::unique_lock<Lock>& lock)
+    {
+        if (!_getters.empty())
+        {
+            waiter* getter = _getters.pop();
+
+            getter->value.emplace(std::move(*value));
+            lock.unlock();
+            getter->handle.resume();
+
+            return true;
+        }
+
+        if (_buffer.is_full() || _buffer.buffer_size() == 0)
+        {
+            return false;
+        }
+
+        _buffer.add(std::move(*value));
+
+        return true;
+    }
+
+    // Adders only wait while the buffer is full : the first of them fills
+    // the slot just released, or hands its element directly when the buffer
+    // has no slot at all.
+    bool _try_get(std::optional<T>& value, std::unique_lock<Lock>& lock)
+    {
+        waiter* adder = nullptr;
+
+        if (!_buffer.is_empty())
+        {
+            value.emplace(_buffer.get());
+
+            if (!_adders.empty())
+            {
+                adder = _adders.pop();
+                _buffer.add(std::move(*adder->value));
+            }
+        }
+        else if (!_adders.empty())
+        {
+            adder = _adders.pop();
+            value.emplace(std::move(*adder->value));
+        }
+        else
+        {
+            return false;
+        }
+
+        if (adder != nullptr)
+        {
+            lock.unlock();
+            adder->handle.resume();
+        }
+
+        return true;
+    }
+};
+
+// Minimal single-threaded executor, mostly for tests : spawn queues a task,
+// run resumes the queued coroutines in order until none is left, and
+// co_await yield() puts the current coroutine back at the end of the queue.
+class circular_buffer_executor
+{
+public :
+    // Fire-and-forget coroutine, started by the executor and destroyed when
+    // it completes.
+    class task
+    {
+    public :
+        struct promise_type
+        {
+            task get_return_object() noexcept
+            {
+                return task(
+                    std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+
+            std::suspend_always initial_suspend() noexcept { return { }; }
+            std::suspend_never final_suspend() noexcept { return { }; }
+            void return_void() noexcept { }
+            void unhandled_exception() noexcept { std::terminate(); }
+        };
+
+        task(task&& other) noexcept :
+            _handle(std::exchange(other._handle, nullptr))
+        { }
+
+        ~task()
+        {
+            if (_handle)
+            {
+                _handle.destroy();
+            }
+        }
+
+    private :
+        friend class circular_buffer_executor;
+
+        std::coroutine_handle<promise_type> _handle;
+
+        explicit task(std::coroutine_handle<promise_type> handle) noexcept :
+            _handle(handle)
+        { }
+    };
+
+    struct yield_awaiter
+    {
+        circular_buffer_executor& executor;
+
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            executor._ready.push_back(handle);
+        }
+
+        void await_resume() const noexcept
+        { }
+    };
+
+    void spawn(task t)
+    {
+        _ready.push_back(std::exchange(t._handle, nullptr));
+    }
+
+    yield_awaiter yield() noexcept
+    {
+        return yield_awaiter{ *this };
+    }
+
+    // Returns the number of resumptions.
+    size_t run()
+    {
+        size_t count = 0;
+
+        while (!_ready.empty())
+        {
+            auto handle = _ready.front();
+
+            _ready.pop_front();
+            handle.resume();
+            ++count;
+        }
+
+        return count;
+    }
+
+private :
+    std::deque<std::coroutine_handle<>> _ready;
+};
+
+#endif
@@ -0,0 +1,301 @@
+#ifndef CIRCULAR_BUFFER_COMMON_HPP_
+# define CIRCULAR_BUFFER_COMMON_HPP_
+
+# include <atomic>
+# include <mutex>
+# include <condition_variable>
+# include <chrono>
+# include <shared_mutex>
+# include <thread>
+# include <type_traits>
+# include <cstddef>
+# include <cstdint>
+
+// Size used to keep state written by different threads on separate cache
+// lines (std::hardware_destructive_interference_size is not ABI stable).
+constexpr std::size_t circular_buffer_cache_line_size = 64;
+
+// What add does when the buffer is full : overwrite the oldest element,
+// reject the new one (add throws, try_add returns false) or block until a
+// get makes room.
+enum class full_policy
+{
+    overwrite,
+    reject,
+    block
+};
+
+// Lock policies : any type with lock/unlock/try_lock can be used, such as
+// std::mutex (the default) or std::recursive_mutex. Lock types that also
+// provide lock_shared, such as std::shared_mutex, let the read-only queries
+// run concurrently. Blocking operations (wait_*, full_policy::block) need a
+// lock that actually excludes other threads.
+
+// Lock for buffers only ever used by a single thread.
+struct null_lock
+{
+    void lock() noexcept { }
+    bool try_lock() noexcept { return true; }
+    void unlock() noexcept { }
+};
+
+// Test and test-and-set spin lock, backing off exponentially before
+// yielding to the scheduler. Suited to very short critical sections.
+class spin_lock
+{
+public :
+    void lock() noexcept
+    {
+        unsigned spins = 0;
+
+        while (_locked.exchange(true, std::memory_order_acquire))
+        {
+            while (_locked.load(std::memory_order_relaxed))
+            {
+                backoff(spins);
+            }
+        }
+    }
+
+    bool try_lock() noexcept
+    {
+        return !_locked.load(std::memory_order_relaxed)
+            && !_locked.exchange(true, std::memory_order_acquire);
+    }
+
+    void unlock() noexcept
+    {
+        _locked.store(false, std::memory_order_release);
+    }
+
+private :
+    std::atomic<bool> _locked = false;
+
+    static void backoff(unsigned& spins) noexcept
+    {
+        if (spins < 10)
+        {
+            for (unsigned n = 0; n < (1u << spins); ++n)
+            {
+# if defined(__x86_64__) || defined(__i386__)
+                __builtin_ia32_pause();
+# elif defined(__aarch64__)
+                asm volatile("yield");
+# endif
+            }
+
+            ++spins;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+};
+
+template <typename Lock>
+concept circular_buffer_shared_lockable = requires(Lock& lock)
+{
+    lock.lock_shared();
+    lock.unlock_shared();
+};
+
+// Guard used by the read-only queries.
+template <typename Lock>
+using circular_buffer_read_lock =
+    std::conditional_t<circular_buffer_shared_lockable<Lock>,
+                       std::shared_lock<Lock>,
+                       std::lock_guard<Lock>>;
+
+template <typename Lock>
+constexpr bool circular_buffer_can_block = !std::is_same_v<Lock, null_lock>;
+
+// Condition variables of the blocking operations. Waiters are counted so
+// that the hot paths skip the notification entirely when nobody is blocked.
+// Buffers whose lock can't block get an empty type instead, which neither
+// takes room nor allocates.
+template <typename Lock, bool = circular_buffer_can_block<Lock>>
+class circular_buffer_waiters
+{
+public :
+    template <typename Predicate>
+    void wait_not_empty(std::unique_lock<Lock>& lock, Predicate ready)
+    {
+        ++_get_waiters;
+        _not_empty.wait(lock, ready);
+        --_get_waiters;
+    }
+
+    template <typename Rep, typename Period, typename Predicate>
+    bool wait_not_empty_for(std::unique_lock<Lock>& lock,
+                            const std::chrono::duration<Rep, Period>& timeout,
+                            Predicate ready)
+    {
+        ++_get_waiters;
+
+        const bool result = _not_empty.wait_for(lock, timeout, ready);
+
+        --_get_waiters;
+
+        return result;
+    }
+
+    template <typename Predicate>
+    void wait_not_full(std::unique_lock<Lock>& lock, Predicate ready)
+    {
+        ++_add_waiters;
+        _not_full.wait(lock, ready);
+        --_add_waiters;
+    }
+
+    // count elements were added or removed.
+    void notify_not_empty(size_t count) noexcept
+    {
+        notify(_not_empty, _get_waiters, count);
+    }
+
+    void notify_not_full(size_t count) noexcept
+    {
+        notify(_not_full, _add_waiters, count);
+    }
+
+    void notify_all_not_full() noexcept
+    {
+        if (_add_waiters > 0)
+        {
+            _not_full.notify_all();
+        }
+    }
+
+private :
+    std::condition_variable_any _not_empty;
+    std::condition_variable_any _not_full;
+    size_t _get_waiters = 0;
+    size_t _add_waiters = 0;
+
+    static void notify(std::condition_variable_any& condition,
+                       size_t waiters,
+                       size_t count) noexcept
+    {
+        if (waiters > 0 && count > 0)
+        {
+            if (count == 1)
+            {
+                condition.notify_one();
+            }
+            else
+            {
+                condition.notify_all();
+            }
+        }
+    }
+};
+
+template <typename Lock>
+class circular_buffer_waiters<Lock, false>
+{
+public :
+    void notify_not_empty(size_t) noexcept { }
+    void notify_not_full(size_t) noexcept { }
+    void notify_all_not_full() noexcept { }
+};
+
+// Counters of a buffer, as returned by snapshot().
+struct circular_buffer_stats
+{
+    uint64_t adds = 0;
+    uint64_t gets = 0;
+    uint64_t overwritten = 0;
+    uint64_t try_get_contended = 0;
+    uint64_t try_get_empty = 0;
+    uint64_t peak_size = 0;
+};
+
+// Stats policies : null_stats (the default) compiles the counters away,
+// counting_stats maintains them. The buffers call the hooks with their lock
+// held, except on_try_get_contended.
+struct null_stats
+{
+    void on_add(size_t, size_t) noexcept { }
+    void on_overwrite(size_t) noexcept { }
+    void on_get(size_t) noexcept { }
+    void on_try_get_contended() noexcept { }
+    void on_try_get_empty() noexcept { }
+
+    circular_buffer_stats snapshot() const noexcept
+    {
+        return { };
+    }
+};
+
+// Counters written under the buffer lock are only ever written by one
+// thread at a time, so they are updated with plain relaxed stores rather
+// than read-modify-write operations; snapshot reads them without the lock.
+class counting_stats
+{
+public :
+    void on_add(size_t count, size_t size) noexcept
+    {
+        increment(_adds, count);
+
+        if (size > _peak_size.load(std::memory_order_relaxed))
+        {
+            _peak_size.store(size, std::memory_order_relaxed);
+        }
+    }
+
+    void on_overwrite(size_t count) noexcept
+    {
+        increment(_overwritten, count);
+    }
+
+    void on_get(size_t count) noexcept
+    {
+        increment(_gets, count);
+    }
+
+    void on_try_get_contended() noexcept
+    {
+        _try_get_contended.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void on_try_get_empty() noexcept
+    {
+        increment(_try_get_empty, 1);
+    }
+
+    circular_buffer_stats snapshot() const noexcept
+    {
+        circular_buffer_stats stats;
+
+        stats.adds = _adds.load(std::memory_order_relaxed);
+        stats.gets = _gets.load(std::memory_order_relaxed);
+        stats.overwritten = _overwritten.load(std::memory_order_relaxed);
+        stats.try_get_contended =
+            _try_get_contended.load(std::memory_order_relaxed);
+        stats.try_get_empty = _try_get_empty.load(std::memory_order_relaxed);
+        stats.peak_size = _peak_size.load(std::memory_order_relaxed);
+
+        return stats;
+    }
+
+private :
+    std::atomic<uint64_t> _adds = 0;
+    std::atomic<uint64_t> _gets = 0;
+    std::atomic<uint64_t> _overwritten = 0;
+    std::atomic<uint64_t> _try_get_empty = 0;
+    std::atomic<uint64_t> _peak_size = 0;
+
+    // Written by the threads failing to take the lock, hence concurrently.
+    alignas(circular_buffer_cache_line_size)
+        std::atomic<uint64_t> _try_get_contended = 0;
+
+    static void increment(std::atomic<uint64_t>& counter, size_t count)
+        noexcept
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + count,
+                      std::memory_order_relaxed);
+    }
+};
+
+#endif
@@ -0,0 +1,258 @@
+#ifndef CIRCULAR_BUFFER_SIMD_HPP_
+# define CIRCULAR_BUFFER_SIMD_HPP_
+
+# include <span>
+# include <limits>
+# include <type_traits>
+# include <cstddef>
+
+# if defined(__AVX__) || defined(__SSE2__)
+#  include <immintrin.h>
+# endif
+
+// Aggregate kernels over contiguous ranges, used on the storage segments of
+// array_circular_buffer. float and double are vectorized with the widest
+// instruction set the translation unit is compiled for (AVX, else SSE2);
+// the other arithmetic types, and the tails, use the scalar loop.
+
+// Sums are accumulated in at least double precision for floating point
+// values, float windows being widened on load, and in the widest integer of
+// the same signedness otherwise.
+template <typename T>
+using circular_buffer_sum_t =
+    std::conditional_t<std::is_floating_point_v<T>,
+        std::conditional_t<(sizeof(T) < sizeof(double)), double, T>,
+        std::conditional_t<std::is_signed_v<T>, long long,
+                           unsigned long long>>;
+
+template <typename T>
+struct circular_buffer_simd;
+
+# if defined(__AVX__)
+template <>
+struct circular_buffer_simd<double>
+{
+    using reg = __m256d;
+
+    static constexpr size_t width = 4;
+
+    static reg load(const double* p) noexcept { return _mm256_loadu_pd(p); }
+    static reg load(const float* p) noexcept
+    {
+        return _mm256_cvtps_pd(_mm_loadu_ps(p));
+    }
+    static reg set1(double v) noexcept { return _mm256_set1_pd(v); }
+    static reg add(reg a, reg b) noexcept { return _mm256_add_pd(a, b); }
+    static reg min(reg a, reg b) noexcept { return _mm256_min_pd(a, b); }
+    static reg max(reg a, reg b) noexcept { return _mm256_max_pd(a, b); }
+    static reg unordered(reg a, reg b) noexcept
+    {
+        return _mm256_cmp_pd(a, b, _CMP_UNORD_Q);
+    }
+    static reg bit_or(reg a, reg b) noexcept { return _mm256_or_pd(a, b); }
+    static void store(double* p, reg a) noexcept { _mm256_storeu_pd(p, a); }
+};
+
+template <>
+struct circular_buffer_simd<float>
+{
+    using reg = __m256;
+
+    static constexpr size_t width = 8;
+
+    static reg load(const float* p) noexcept { return _mm256_loadu_ps(p); }
+    static reg set1(float v) noexcept { return _mm256_set1_ps(v); }
+    static reg add(reg a, reg b) noexcept { return _mm256_add_ps(a, b); }
+    static reg min(reg a, reg b) noexcept { return _mm256_min_ps(a, b); }
+    static reg max(reg a, reg b) noexcept { return _mm256_max_ps(a, b); }
+    static reg unordered(reg a, reg b) noexcept
+    {
+        return _mm256_cmp_ps(a, b, _CMP_UNORD_Q);
+    }
+    static reg bit_or(reg a, reg b) noexcept { return _mm256_or_ps(a, b); }
+    static void store(float* p, reg a) noexcept { _mm256_storeu_ps(p, a); }
+};
+# elif defined(__SSE2__)
+template <>
+struct circular_buffer_simd<double>
+{
+    using reg = __m128d;
+
+    static constexpr size_t width = 2;
+
+    static reg load(const double* p) noexcept { return _mm_loadu_pd(p); }
+    static reg load(const float* p) noexcept
+    {
+        return _mm_cvtps_pd(_mm_castsi128_ps(
+                   _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p))));
+    }
+    static reg set1(double v) noexcept { return _mm_set1_pd(v); }
+    static reg add(reg a, reg b) noexcept { return _mm_add_pd(a, b); }
+    static reg min(reg a, reg b) noexcept { return _mm_min_pd(a, b); }
+    static reg max(reg a, reg b) noexcept { return _mm_max_pd(a, b); }
+    static reg unordered(reg a, reg b) noexcept
+    {
+        return _mm_cmpunord_pd(a, b);
+    }
+    static reg bit_or(reg a, reg b) noexcept { return _mm_or_pd(a, b); }
+    static void store(double* p, reg a) noexcept { _mm_storeu_pd(p, a); }
+};
+
+template <>
+struct circular_buffer_simd<float>
+{
+    using reg = __m128;
+
+    static constexpr size_t width = 4;
+
+    static reg load(const float* p) noexcept { return _mm_loadu_ps(p); }
+    static reg set1(float v) noexcept { return _mm_set1_ps(v); }
+    static reg add(reg a, reg b) noexcept { return _mm_add_ps(a, b); }
+    static reg min(reg a, reg b) noexcept { return _mm_min_ps(a, b); }
+    static reg max(reg a, reg b) noexcept { return _mm_max_ps(a, b); }
+    static reg unordered(reg a, reg b) noexcept
+    {
+        return _mm_cmpunord_ps(a, b);
+    }
+    static reg bit_or(reg a, reg b) noexcept { return _mm_or_ps(a, b); }
+    static void store(float* p, reg a) noexcept { _mm_storeu_ps(p, a); }
+};
+# endif
+
+template <typename T>
+concept circular_buffer_vectorized = requires
+{
+    circular_buffer_simd<T>::width;
+};
+
+template <typename T>
+circular_buffer_sum_t<T> circular_buffer_sum(std::span<const T> values)
+    noexcept
+{
+    using sum_type = circular_buffer_sum_t<T>;
+
+    sum_type sum = 0;
+    size_t n = 0;
+
+    if constexpr (circular_buffer_vectorized<T>
+                  && circular_buffer_vectorized<sum_type>)
+    {
+        // The lanes hold sum_type values, loaded from T ones.
+        using simd = circular_buffer_simd<sum_type>;
+
+        // Four independent accumulators hide the latency of the additions.
+        constexpr size_t step = 4 * simd::width;
+
+        if (values.size() >= step)
+        {
+            const T* p = values.data();
+            auto a0 = simd::set1(0);
+            auto a1 = a0;
+            auto a2 = a0;
+            auto a3 = a0;
+
+            for (; n + step <= values.size(); n += step)
+            {
+                a0 = simd::add(a0, simd::load(p + n));
+                a1 = simd::add(a1, simd::load(p + n + simd::width));
+                a2 = simd::add(a2, simd::load(p + n + 2 * simd::width));
+                a3 = simd::add(a3, simd::load(p + n + 3 * simd::width));
+            }
+
+            sum_type lanes[simd::width];
+
+            simd::store(lanes, simd::add(simd::add(a0, a1),
+                                         simd::add(a2, a3)));
+
+            for (sum_type lane : lanes)
+            {
+                sum += lane;
+            }
+        }
+    }
+
+    for (; n < values.size(); ++n)
+    {
+        sum += values[n];
+    }
+
+    return sum;
+}
+
+// Smallest (Max false) or largest (Max true) value of a non empty range. A
+// NaN anywhere in the range makes the result NaN, in the vectorized body as
+// in the scalar tail : the min/max instructions drop a NaN accumulator, so
+// NaNs are tracked apart with an unordered comparison.
+template <bool Max, typename T>
+T circular_buffer_extremum(std::span<const T> values) noexcept
+{
+    auto pick = [](T a, T b)
+    {
+        return (b != b || (Max ? b > a : b < a)) ? b : a;
+    };
+    T result = values[0];
+    size_t n = 0;
+
+    if constexpr (circular_buffer_vectorized<T>)
+    {
+        using simd = circular_buffer_simd<T>;
+
+        constexpr size_t step = 2 * simd::width;
+
+        if (values.size() >= step)
+        {
+            const T* p = values.data();
+            auto a0 = simd::set1(result);
+            auto a1 = a0;
+            auto unordered = simd::unordered(a0, a0);
+
+            for (; n + step <= values.size(); n += step)
+            {
+                const auto v0 = simd::load(p + n);
+                const auto v1 = simd::load(p + n + simd::width);
+
+                if constexpr (Max)
+                {
+                    a0 = simd::max(a0, v0);
+                    a1 = simd::max(a1, v1);
+                }
+                else
+                {
+                    a0 = simd::min(a0, v0);
+                    a1 = simd::min(a1, v1);
+                }
+
+                unordered = simd::bit_or(unordered, simd::unordered(v0, v1));
+            }
+
+            T lanes[simd::width];
+
+            // Lanes of the mask are all ones, which is a NaN, or all zeros.
+            simd::store(lanes, unordered);
+
+            for (T lane : lanes)
+            {
+                if (lane != lane)
+                {
+                    return std::numeric_limits<T>::quiet_NaN();
+                }
+            }
+
+            simd::store(lanes, Max ? simd::max(a0, a1) : simd::min(a0, a1));
+
+            for (T lane : lanes)
+            {
+                result = pick(result, lane);
+            }
+        }
+    }
+
+    for (; n < values.size(); ++n)
+    {
+        result = pick(result, values[n]);
+    }
+
+    return result;
+}
+
+#endif
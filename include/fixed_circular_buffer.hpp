@@ -0,0 +1,204 @@
+#ifndef FIXED_CIRCULAR_BUFFER_HPP_
+# define FIXED_CIRCULAR_BUFFER_HPP_
+
+# include <array>
+# include <mutex>
+# include <utility>
+# include <type_traits>
+# include <stdexcept>
+# include <cstddef>
+
+# include "circular_buffer_common.hpp"
+
+// Circular buffer with a compile-time capacity stored inline, so it never
+// allocates and can be embedded in other objects. When N is a power of two
+// the indices wrap with a mask instead of a modulo.
+template <typename T, size_t N, typename Lock = std::mutex>
+class fixed_circular_buffer
+{
+    static_assert(N > 0, "fixed circular buffer needs at least one element");
+
+public :
+    fixed_circular_buffer()
+        noexcept(std::is_nothrow_default_constructible_v<T>) :
+        _start(0), _end(0), _full(false)
+    { }
+
+    fixed_circular_buffer(const fixed_circular_buffer& other)
+    {
+        std::lock_guard<Lock> lock(other._mutex);
+
+        this->fcb_copy(other);
+    }
+
+    fixed_circular_buffer(fixed_circular_buffer&& other)
+    {
+        std::lock_guard<Lock> lock(other._mutex);
+
+        this->fcb_move(std::move(other));
+    }
+
+    fixed_circular_buffer& operator=(const fixed_circular_buffer& other)
+    {
+        if (this != &other)
+        {
+            std::scoped_lock lock(other._mutex, _mutex);
+
+            this->fcb_copy(other);
+        }
+
+        return *this;
+    }
+
+    fixed_circular_buffer& operator=(fixed_circular_buffer&& other)
+    {
+        if (this != &other)
+        {
+            std::scoped_lock lock(other._mutex, _mutex);
+
+            this->fcb_move(std::move(other));
+        }
+
+        return *this;
+    }
+
+    static constexpr size_t buffer_size() noexcept
+    {
+        return N;
+    }
+
+    bool is_empty() const
+    {
+        circular_buffer_read_lock<Lock> lock(_mutex);
+
+        return !_full && _start == _end;
+    }
+
+    bool is_full() const
+    {
+        circular_buffer_read_lock<Lock> lock(_mutex);
+
+        return _full;
+    }
+
+    void clear()
+    {
+        std::lock_guard<Lock> lock(_mutex);
+
+        _start = 0;
+        _end = 0;
+        _full = false;
+    }
+
+    fixed_circular_buffer& add(const T& value)
+    {
+        std::lock_guard<Lock> lock(_mutex);
+
+        _buffer[_end] = value;
+        this->post_add();
+
+        return *this;
+    }
+
+    fixed_circular_buffer& add(T&& value)
+    {
+        std::lock_guard<Lock> lock(_mutex);
+
+        _buffer[_end] = std::move(value);
+        this->post_add();
+
+        return *this;
+    }
+
+    T get()
+    {
+        std::lock_guard<Lock> lock(_mutex);
+
+        if (!_full && _start == _end)
+        {
+            throw std::out_of_range("circular buffer is empty");
+        }
+
+        return this->_get();
+    }
+
+    bool try_get(T& value)
+    {
+        std::unique_lock<Lock> lock(_mutex, std::try_to_lock);
+
+        if (!lock.owns_lock())
+        {
+            return false;
+        }
+
+        if (!_full && _start == _end)
+        {
+            return false;
+        }
+
+        value = this->_get();
+
+        return true;
+    }
+
+private :
+    std::array<T, N> _buffer;
+    size_t _start;
+    size_t _end;
+    bool _full;
+    mutable Lock _mutex;
+
+    static constexpr size_t next(size_t n) noexcept
+    {
+        if constexpr ((N & (N - 1)) == 0)
+        {
+            return (n + 1) & (N - 1);
+        }
+        else
+        {
+            return (n + 1) % N;
+        }
+    }
+
+    void fcb_copy(const fixed_circular_buffer& other)
+    {
+        _buffer = other._buffer;
+        _start = other._start;
+        _end = other._end;
+        _full = other._full;
+    }
+
+    void fcb_move(fixed_circular_buffer&& other)
+    {
+        _buffer = std::move(other._buffer);
+        _start = std::exchange(other._start, 0);
+        _end = std::exchange(other._end, 0);
+        _full = std::exchange(other._full, false);
+    }
+
+    void post_add() noexcept
+    {
+        _end = next(_end);
+
+        if (_full)
+        {
+            _start = _end;
+        }
+        else if (_end == _start)
+        {
+            _full = true;
+        }
+    }
+
+    T _get()
+    {
+        T value = std::move(_buffer[_start]);
+
+        _start = next(_start);
+        _full = false;
+
+        return value;
+    }
+};
+
+#endif
@@ -3,15 +3,105 @@
 
 # include <memory>
 # include <mutex>
+# include <chrono>
 # include <utility>
+# include <algorithm>
+# include <iterator>
+# include <type_traits>
 # include <stdexcept>
+# include <cstddef>
 # include <cstdint>
 
-template <typename T>
+# include "circular_buffer_common.hpp"
+
+template <typename T,
+          full_policy Policy = full_policy::overwrite,
+          typename Lock = std::mutex,
+          typename Stats = null_stats>
 class list_circular_buffer
 {
+    class circular_singly_linked_list;
+
 public :
-    list_circular_buffer() noexcept : _full(false) { }
+    // Forward iterator over the stored elements, oldest first.
+    template <bool Const>
+    class basic_iterator
+    {
+        using node_pointer = std::conditional_t<
+            Const,
+            const typename circular_singly_linked_list::node*,
+            typename circular_singly_linked_list::node*>;
+
+    public :
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const, const T*, T*>;
+        using reference = std::conditional_t<Const, const T&, T&>;
+
+        basic_iterator() noexcept :
+            _node(nullptr), _index(0)
+        { }
+
+        basic_iterator(node_pointer node, size_t index) noexcept :
+            _node(node), _index(index)
+        { }
+
+        operator basic_iterator<true>() const noexcept requires (!Const)
+        {
+            return basic_iterator<true>(_node, _index);
+        }
+
+        reference operator*() const noexcept
+        {
+            return _node->value;
+        }
+
+        pointer operator->() const noexcept
+        {
+            return &_node->value;
+        }
+
+        basic_iterator& operator++() noexcept
+        {
+            _node = _node->next;
+            ++_index;
+
+            return *this;
+        }
+
+        basic_iterator operator++(int) noexcept
+        {
+            basic_iterator it = *this;
+
+            ++*this;
+
+            return it;
+        }
+
+        // The position is compared rather than the node, which is the same
+        // for begin and end when the buffer is full.
+        friend bool operator==(const basic_iterator& lhs,
+                               const basic_iterator& rhs) noexcept
+        {
+            return lhs._index == rhs._index;
+        }
+
+    private :
+        node_pointer _node;
+        size_t _index;
+    };
+
+    using value_type = T;
+    using size_type = size_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using iterator = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    list_circular_buffer() noexcept :
+        _start(nullptr), _end(nullptr), _full(false)
+    { }
 
     list_circular_buffer(size_t size) :
         _list(size),
@@ -22,25 +112,24 @@ public :
 
     list_circular_buffer(const list_circular_buffer& other)
     {
-        std::lock_guard<std::recursive_mutex> lock(other._mutex);
+        std::lock_guard<Lock> lock(other._mutex);
 
         this->lcb_copy(other);
     }
 
     list_circular_buffer(list_circular_buffer&& other)
     {
-        std::lock_guard<std::recursive_mutex> lock(other._mutex);
+        std::lock_guard<Lock> lock(other._mutex);
 
         this->lcb_move(std::move(other));
     }
 
     list_circular_buffer& operator=(const list_circular_buffer& other)
     {
-        std::lock_guard<std::recursive_mutex> lock(other._mutex);
-        std::lock_guard<std::recursive_mutex> lock2(_mutex);
-
         if (this != &other)
         {
+            std::scoped_lock lock(other._mutex, _mutex);
+
             this->lcb_copy(other);
         }
 
@@ -49,11 +138,10 @@ public :
 
     list_circular_buffer& operator=(list_circular_buffer&& other)
     {
-        std::lock_guard<std::recursive_mutex> lock(other._mutex);
-        std::lock_guard<std::recursive_mutex> lock2(_mutex);
-
         if (this != &other)
         {
+            std::scoped_lock lock(other._mutex, _mutex);
+
             this->lcb_move(std::move(other));
         }
 
@@ -62,14 +150,21 @@ public :
 
     size_t buffer_size() const
     {
-        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        circular_buffer_read_lock<Lock> lock(_mutex);
 
         return _list._size;
     }
 
+    size_t size() const
+    {
+        circular_buffer_read_lock<Lock> lock(_mutex);
+
+        return this->_size();
+    }
+
     bool is_empty() const
     {
-        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        circular_buffer_read_lock<Lock> lock(_mutex);
 
         if (_full)
         {
@@ -81,109 +176,90 @@ public :
 
     bool is_full() const
     {
-        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        circular_buffer_read_lock<Lock> lock(_mutex);
 
         return _full;
     }
 
     void clear()
     {
-        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        std::lock_guard<Lock> lock(_mutex);
 
         _start = _list._head;
         _end = _list._head;
         _full = false;
+
+        this->notify_resized();
     }
 
+    // Moves the stored elements, oldest first, to the start of a new list;
+    // when shrinking, only the newest buffer_size elements are kept.
     void resize(size_t buffer_size)
     {
-        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        std::lock_guard<Lock> lock(_mutex);
 
         if (buffer_size == _list._size)
         {
             return;
         }
 
-        if (buffer_size == 0)
-        {
-            *this = list_circular_buffer();
-        }
-        else if (buffer_size > _list._size && _list._size == 0)
-        {
-            *this = list_circular_buffer(buffer_size);
-        }
-        else
+        const size_t size = this->_size();
+        const size_t kept = std::min(size, buffer_size);
+        circular_singly_linked_list list(buffer_size);
+
+        if (kept > 0)
         {
-            auto curr = _list._head;
-            uint32_t n = 0;
+            size_t index = _list.index_of(_start) + size - kept;
 
-            while (curr != _start)
+            if (index >= _list._size)
             {
-                curr = curr->next;
-                ++n;
+                index -= _list._size;
             }
 
-            auto lcb_old = std::move(*this);
-
-            _list = circular_singly_linked_list(buffer_size);
-            curr = _list._head;
-
-            for (uint32_t n2 = 0; n2 < n; ++n2)
+            for (size_t n = 0; n < kept; ++n)
             {
-                curr = curr->next;
-            }
-
-            _start = curr;
-            _end = curr;
+                list._head[n].value = std::move(_list._head[index].value);
 
-            while (!lcb_old.is_empty())
-            {
-                this->add(lcb_old.get());
+                if (++index == _list._size)
+                {
+                    index = 0;
+                }
             }
         }
+
+        _list = std::move(list);
+        _start = _list._head;
+        _end = kept < buffer_size ? _list._head + kept : _list._head;
+        _full = buffer_size > 0 && kept == buffer_size;
+
+        this->notify_resized();
     }
 
     list_circular_buffer& add(const T& value)
     {
-        std::lock_guard<std::recursive_mutex> lock(_mutex);
-
-        if (_list._size == 0)
-        {
-            throw std::out_of_range(
-                      "circular buffer doesn't have space memory to store");
-        }
-
-        _end->value = value;
-        _end = _end->next;
-
-        this->post_add();
+        return this->_add(value);
+    }
 
-        return *this;
+    bool try_add(const T& value)
+    {
+        return this->_try_add(value);
     }
 
     list_circular_buffer& add(T&& value)
     {
-        std::lock_guard<std::recursive_mutex> lock(_mutex);
-
-        if (_list._size == 0)
-        {
-            throw std::out_of_range(
-                      "circular buffer doesn't have space memory to store");
-        }
-
-        _end->value = std::move(value);
-        _end = _end->next;
-
-        this->post_add();
+        return this->_add(std::move(value));
+    }
 
-        return *this;
+    bool try_add(T&& value)
+    {
+        return this->_try_add(std::move(value));
     }
 
     T get()
     {
-        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        std::lock_guard<Lock> lock(_mutex);
 
-        if (this->is_empty())
+        if (this->_is_empty())
         {
             throw std::out_of_range("circular buffer is empty");
         }
@@ -193,15 +269,19 @@ public :
 
     bool try_get(T& value)
     {
-        std::unique_lock<std::recursive_mutex> lock(_mutex, std::try_to_lock);
+        std::unique_lock<Lock> lock(_mutex, std::try_to_lock);
 
         if (!lock.owns_lock())
         {
+            _stats.on_try_get_contended();
+
             return false;
         }
 
-        if (this->is_empty())
+        if (this->_is_empty())
         {
+            _stats.on_try_get_empty();
+
             return false;
         }
 
@@ -210,45 +290,193 @@ public :
         return true;
     }
 
+    T wait_get()
+    {
+        static_assert(circular_buffer_can_block<Lock>,
+                      "blocking operations need a real lock");
+
+        std::unique_lock<Lock> lock(_mutex);
+
+        _waiters.wait_not_empty(lock, [this]() { return !this->_is_empty(); });
+
+        return this->_get();
+    }
+
+    template <typename Rep, typename Period>
+    bool wait_get_for(T& value,
+                      const std::chrono::duration<Rep, Period>& timeout)
+    {
+        static_assert(circular_buffer_can_block<Lock>,
+                      "blocking operations need a real lock");
+
+        std::unique_lock<Lock> lock(_mutex);
+
+        bool ready = _waiters.wait_not_empty_for(lock, timeout, [this]()
+        {
+            return !this->_is_empty();
+        });
+
+        if (!ready)
+        {
+            return false;
+        }
+
+        value = this->_get();
+
+        return true;
+    }
+
+    list_circular_buffer& wait_add(const T& value)
+    {
+        return this->_wait_add(value);
+    }
+
+    list_circular_buffer& wait_add(T&& value)
+    {
+        return this->_wait_add(std::move(value));
+    }
+
+    // Calls fn on up to n of the oldest elements, in place and under a single
+    // lock, then releases them all at once; returns how many were consumed.
+    // If fn throws, no element is consumed.
+    template <typename Fn>
+    size_t consume_up_to(size_t n, Fn&& fn)
+    {
+        std::lock_guard<Lock> lock(_mutex);
+
+        const size_t count = std::min(n, this->_size());
+        node_t* node = _start;
+
+        for (size_t i = 0; i < count; ++i, node = node->next)
+        {
+            fn(node->value);
+        }
+
+        if (count > 0)
+        {
+            _start = node;
+            _full = false;
+
+            _stats.on_get(count);
+            this->notify_removed(count);
+        }
+
+        return count;
+    }
+
+    template <typename Fn>
+    size_t consume_all(Fn&& fn)
+    {
+        return this->consume_up_to(SIZE_MAX, fn);
+    }
+
+    // Counters of the Stats policy, read without taking the lock.
+    circular_buffer_stats snapshot() const noexcept
+    {
+        return _stats.snapshot();
+    }
+
+    // Element access and iterators, relative to the oldest element. They
+    // don't lock : the references and iterators are only valid while no
+    // other call modifies the buffer. The nodes being stored in index order,
+    // operator[] and at don't walk the list.
+    T& operator[](size_t n) noexcept
+    {
+        return this->node_at(n)->value;
+    }
+
+    const T& operator[](size_t n) const noexcept
+    {
+        return this->node_at(n)->value;
+    }
+
+    T& at(size_t n)
+    {
+        return this->_at(*this, n);
+    }
+
+    const T& at(size_t n) const
+    {
+        return this->_at(*this, n);
+    }
+
+    T& front()
+    {
+        return this->_at(*this, 0);
+    }
+
+    const T& front() const
+    {
+        return this->_at(*this, 0);
+    }
+
+    T& back()
+    {
+        return this->_back(*this);
+    }
+
+    const T& back() const
+    {
+        return this->_back(*this);
+    }
+
+    iterator begin() noexcept
+    {
+        return iterator(_start, 0);
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return const_iterator(_start, 0);
+    }
+
+    const_iterator cbegin() const noexcept
+    {
+        return this->begin();
+    }
+
+    iterator end() noexcept
+    {
+        return iterator(_end, this->_size());
+    }
+
+    const_iterator end() const noexcept
+    {
+        return const_iterator(_end, this->_size());
+    }
+
+    const_iterator cend() const noexcept
+    {
+        return this->end();
+    }
+
 private :
+    // The nodes live in a single array linked in index order, so the whole
+    // ring is allocated and freed at once and walking it stays cache
+    // friendly.
     class circular_singly_linked_list final
     {
     public :
         struct node
         {
             T value;
-            std::shared_ptr<node> next;
-
-            node() = default;
-
-            node(const T& value) noexcept(noexcept(T(std::declval<T&>()))) :
-                value(value)
-            { }
+            node* next = nullptr;
         };
 
         size_t _size;
-        std::shared_ptr<node> _head;
-        std::shared_ptr<node> _tail;
+        std::unique_ptr<node[]> _nodes;
+        node* _head;
+        node* _tail;
 
-        circular_singly_linked_list() noexcept : _size(0) { }
+        circular_singly_linked_list() noexcept :
+            _size(0), _head(nullptr), _tail(nullptr)
+        { }
 
-        circular_singly_linked_list(size_t size) : _size(size)
+        circular_singly_linked_list(size_t size) :
+            _size(size),
+            _nodes(size > 0 ? std::make_unique<node[]>(size) : nullptr)
         {
-            if (size > 0)
-            {
-                _head = std::make_shared<node>();
-
-                auto curr = _head;
-
-                for (uint32_t n = 1; n < size; ++n)
-                {
-                    curr->next = std::make_shared<node>();
-                    curr = curr->next;
-                }
-
-                _tail = std::move(curr);
-                _tail->next = _head;
-            }
+            this->link();
         }
 
         circular_singly_linked_list(const circular_singly_linked_list& other)
@@ -257,6 +485,7 @@ private :
         }
 
         circular_singly_linked_list(circular_singly_linked_list&& other)
+            noexcept
         {
             this->csll_move(std::move(other));
         }
@@ -273,7 +502,7 @@ private :
         }
 
         circular_singly_linked_list& operator=(
-            circular_singly_linked_list&& other)
+            circular_singly_linked_list&& other) noexcept
         {
             if (this != &other)
             {
@@ -283,115 +512,166 @@ private :
             return *this;
         }
 
-    private :
-        void csll_copy(const circular_singly_linked_list& other)
+        size_t index_of(const node* n) const noexcept
         {
-            _size = other._size;
+            return n - _head;
+        }
 
-            if (other._size == 0)
+    private :
+        void link() noexcept
+        {
+            if (_size == 0)
             {
-                _head.reset();
-                _tail.reset();
+                _head = nullptr;
+                _tail = nullptr;
+
+                return;
             }
-            else
+
+            _head = _nodes.get();
+            _tail = _head + _size - 1;
+
+            for (size_t n = 0; n + 1 < _size; ++n)
             {
-                _head = std::make_shared<node>(other._head->value);
+                _head[n].next = _head + n + 1;
+            }
 
-                auto curr = _head;
-                auto curr2 = other._head;
+            _tail->next = _head;
+        }
 
-                for (uint32_t n = 1; n < other._size; ++n)
-                {
-                    curr->next = std::make_shared<node>(curr2->next->value);
-                    curr = curr->next;
-                    curr2 = curr2->next;
-                }
+        void csll_copy(const circular_singly_linked_list& other)
+        {
+            auto nodes = other._size > 0
+                       ? std::make_unique<node[]>(other._size) : nullptr;
 
-                _tail = std::move(curr);
-                _tail->next = _head;
+            for (size_t n = 0; n < other._size; ++n)
+            {
+                nodes[n].value = other._head[n].value;
             }
+
+            _size = other._size;
+            _nodes = std::move(nodes);
+            this->link();
         }
 
-        void csll_move(circular_singly_linked_list&& other)
+        void csll_move(circular_singly_linked_list&& other) noexcept
         {
-            _size = other._size;
-            _head = std::move(other._head);
-            _tail = std::move(other._tail);
+            _size = std::exchange(other._size, 0);
+            _nodes = std::move(other._nodes);
+            _head = std::exchange(other._head, nullptr);
+            _tail = std::exchange(other._tail, nullptr);
         }
     };
 
-
     using node_t = typename circular_singly_linked_list::node;
 
     circular_singly_linked_list _list;
-    std::shared_ptr<node_t> _start;
-    std::shared_ptr<node_t> _end;
+    node_t* _start;
+    node_t* _end;
     bool _full;
-    mutable std::recursive_mutex _mutex;
+    mutable Lock _mutex;
+    [[no_unique_address]] Stats _stats;
+    [[no_unique_address]] circular_buffer_waiters<Lock> _waiters;
 
     void lcb_copy(const list_circular_buffer& other)
     {
         _list = other._list;
 
-        auto curr = _list._head;
-        auto curr2 = _list._head;
-        auto curr3 = other._list._head;
-        bool start_found = false;
-        bool end_found = false;
+        if (_list._size == 0)
+        {
+            _start = nullptr;
+            _end = nullptr;
+        }
+        else
+        {
+            _start = _list._head + other._list.index_of(other._start);
+            _end = _list._head + other._list.index_of(other._end);
+        }
+
+        _full = other._full;
+    }
 
-        while (1)
+    void lcb_move(list_circular_buffer&& other)
+    {
+        _list = std::exchange(other._list, circular_singly_linked_list());
+        _start = std::exchange(other._start, nullptr);
+        _end = std::exchange(other._end, nullptr);
+        _full = std::exchange(other._full, false);
+    }
+
+    // Only the overwrite policy may push into a full buffer, replacing the
+    // oldest element.
+    template <typename U>
+    void push(U&& value)
+    {
+        _end->value = std::forward<U>(value);
+        _end = _end->next;
+
+        if constexpr (Policy == full_policy::overwrite)
         {
-            if (curr3 == other._start)
+            if (_full)
             {
-                start_found = true;
-            }
+                _stats.on_overwrite(1);
+                _start = _end;
 
-            if (curr3 == other._end)
-            {
-                end_found = true;
+                return;
             }
+        }
 
-            if (!start_found)
-            {
-                curr = curr->next;
-            }
+        _full = _end == _start;
+    }
 
-            if (!end_found)
-            {
-                curr2 = curr2->next;
-            }
+    template <typename U>
+    list_circular_buffer& _add(U&& value)
+    {
+        std::unique_lock<Lock> lock(_mutex);
+
+        if (_list._size == 0)
+        {
+            throw std::out_of_range(
+                      "circular buffer doesn't have space memory to store");
+        }
 
-            if (start_found && end_found)
+        if constexpr (Policy == full_policy::reject)
+        {
+            if (_full)
             {
-                break;
+                throw std::out_of_range("circular buffer is full");
             }
-
-            curr3 = curr3->next;
+        }
+        else if constexpr (Policy == full_policy::block)
+        {
+            this->wait_not_full(lock);
         }
 
-        _start = curr;
-        _end = curr2;
-        _full = other._full;
-    }
+        this->push(std::forward<U>(value));
+        this->notify_added();
 
-    void lcb_move(list_circular_buffer&& other)
-    {
-        _list = std::exchange(other._list, circular_singly_linked_list());
-        _start = std::exchange(other._start, nullptr);
-        _end = std::exchange(other._end, nullptr);
-        _full = std::exchange(other._full, false);
+        return *this;
     }
 
-    void post_add() noexcept
+    template <typename U>
+    bool _try_add(U&& value)
     {
-        if (_end == _start)
+        std::unique_lock<Lock> lock(_mutex, std::try_to_lock);
+
+        if (!lock.owns_lock() || _list._size == 0)
         {
-            _full = true;
+            return false;
         }
-        else if (_full)
+
+        if constexpr (Policy != full_policy::overwrite)
         {
-            _start = _start->next;
+            if (_full)
+            {
+                return false;
+            }
         }
+
+        this->push(std::forward<U>(value));
+        this->notify_added();
+
+        return true;
     }
 
     T _get()
@@ -405,8 +685,121 @@ private :
             _full = false;
         }
 
+        _stats.on_get(1);
+        this->notify_removed();
+
         return value;
     }
+
+    bool _is_empty() const noexcept
+    {
+        return !_full && _start == _end;
+    }
+
+    size_t _size() const noexcept
+    {
+        if (_full)
+        {
+            return _list._size;
+        }
+
+        const size_t start = _list.index_of(_start);
+        const size_t end = _list.index_of(_end);
+
+        return end >= start ? end - start : _list._size - start + end;
+    }
+
+    node_t* node_at(size_t n) const noexcept
+    {
+        size_t index = _list.index_of(_start) + n;
+
+        if (index >= _list._size)
+        {
+            index -= _list._size;
+        }
+
+        return _list._head + index;
+    }
+
+    template <typename Self>
+    static auto& _at(Self& self, size_t n)
+    {
+        circular_buffer_read_lock<Lock> lock(self._mutex);
+
+        if (n >= self._size())
+        {
+            if (self._is_empty())
+            {
+                throw std::out_of_range("circular buffer is empty");
+            }
+
+            throw std::out_of_range("circular buffer index out of range");
+        }
+
+        return self[n];
+    }
+
+    template <typename Self>
+    static auto& _back(Self& self)
+    {
+        circular_buffer_read_lock<Lock> lock(self._mutex);
+
+        if (self._is_empty())
+        {
+            throw std::out_of_range("circular buffer is empty");
+        }
+
+        return self[self._size() - 1];
+    }
+
+    template <typename U>
+    list_circular_buffer& _wait_add(U&& value)
+    {
+        std::unique_lock<Lock> lock(_mutex);
+
+        if (_list._size == 0)
+        {
+            throw std::out_of_range(
+                      "circular buffer doesn't have space memory to store");
+        }
+
+        this->wait_not_full(lock);
+        this->push(std::forward<U>(value));
+        this->notify_added();
+
+        return *this;
+    }
+
+    void wait_not_full(std::unique_lock<Lock>& lock)
+    {
+        static_assert(circular_buffer_can_block<Lock>,
+                      "blocking operations need a real lock");
+
+        _waiters.wait_not_full(lock, [this]() { return !_full; });
+
+        // The buffer may have been resized to 0 while waiting.
+        if (_list._size == 0)
+        {
+            throw std::out_of_range(
+                      "circular buffer doesn't have space memory to store");
+        }
+    }
+
+    void notify_added()
+    {
+        _stats.on_add(1, this->_size());
+        _waiters.notify_not_empty(1);
+    }
+
+    void notify_removed(size_t count = 1)
+    {
+        _waiters.notify_not_full(count);
+    }
+
+    void notify_resized()
+    {
+        _waiters.notify_all_not_full();
+    }
 };
 
 #endif
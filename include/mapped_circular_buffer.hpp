@@ -0,0 +1,367 @@
+#ifndef MAPPED_CIRCULAR_BUFFER_HPP_
+# define MAPPED_CIRCULAR_BUFFER_HPP_
+
+# include <atomic>
+# include <mutex>
+# include <string>
+# include <utility>
+# include <type_traits>
+# include <stdexcept>
+# include <system_error>
+# include <cerrno>
+# include <cstring>
+# include <cstdint>
+# include <cstddef>
+
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+
+# include "circular_buffer_common.hpp"
+
+// Circular buffer stored in a memory-mapped file, so that its content
+// survives the process : reopening the file maps it back as is, without
+// reading it. The indices live in a small header in front of the elements
+// and only ever grow; an element is written before the end index that
+// publishes it, and the oldest element is dropped before its slot is
+// overwritten, so a crash never exposes a partially written element.
+// sync() additionally flushes the mapping to disk. As with
+// array_circular_buffer, add overwrites the oldest element when full.
+template <typename T, typename Lock = std::mutex>
+class mapped_circular_buffer
+{
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "mapped circular buffer elements must be trivially copyable");
+    static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+public :
+    // Opens the buffer stored in path, or creates it with room for
+    // buffer_size elements if the file doesn't exist or is empty. An existing
+    // buffer keeps its own capacity; any other file is left untouched.
+    mapped_circular_buffer(const std::string& path, size_t buffer_size) :
+        mapped_circular_buffer()
+    {
+        this->open(path, O_RDWR | O_CREAT, buffer_size);
+    }
+
+    // Opens the buffer stored in path, which must already exist.
+    explicit mapped_circular_buffer(const std::string& path) :
+        mapped_circular_buffer()
+    {
+        this->open(path, O_RDWR, 0);
+    }
+
+    mapped_circular_buffer(const mapped_circular_buffer&) = delete;
+    mapped_circular_buffer& operator=(const mapped_circular_buffer&) = delete;
+
+    mapped_circular_buffer(mapped_circular_buffer&& other) :
+        mapped_circular_buffer()
+    {
+        std::lock_guard<Lock> lock(other._mutex);
+
+        this->mcb_move(std::move(other));
+    }
+
+    mapped_circular_buffer& operator=(mapped_circular_buffer&& other)
+    {
+        if (this != &other)
+        {
+            std::scoped_lock lock(other._mutex, _mutex);
+
+            this->mcb_move(std::move(other));
+        }
+
+        return *this;
+    }
+
+    ~mapped_circular_buffer()
+    {
+        this->unmap();
+    }
+
+    size_t buffer_size() const
+    {
+        circular_buffer_read_lock<Lock> lock(_mutex);
+
+        return _buffer_size;
+    }
+
+    size_t size() const
+    {
+        circular_buffer_read_lock<Lock> lock(_mutex);
+
+        return this->_size();
+    }
+
+    bool is_empty() const
+    {
+        circular_buffer_read_lock<Lock> lock(_mutex);
+
+        return this->_size() == 0;
+    }
+
+    bool is_full() const
+    {
+        circular_buffer_read_lock<Lock> lock(_mutex);
+
+        return _buffer_size > 0 && this->_size() == _buffer_size;
+    }
+
+    void clear()
+    {
+        std::lock_guard<Lock> lock(_mutex);
+
+        if (_header != nullptr)
+        {
+            _header->start.store(_header->end.load(std::memory_order_relaxed),
+                                 std::memory_order_release);
+        }
+    }
+
+    mapped_circular_buffer& add(const T& value)
+    {
+        std::lock_guard<Lock> lock(_mutex);
+
+        if (_buffer_size == 0)
+        {
+            throw std::out_of_range(
+                      "circular buffer doesn't have space memory to store");
+        }
+
+        const uint64_t start = _header->start.load(std::memory_order_relaxed);
+        const uint64_t end = _header->end.load(std::memory_order_relaxed);
+
+        if (end - start == _buffer_size)
+        {
+            _header->start.store(start + 1, std::memory_order_release);
+        }
+
+        std::memcpy(_buffer + end % _buffer_size, &value, sizeof(T));
+        _header->end.store(end + 1, std::memory_order_release);
+
+        return *this;
+    }
+
+    T get()
+    {
+        std::lock_guard<Lock> lock(_mutex);
+
+        if (this->_size() == 0)
+        {
+            throw std::out_of_range("circular buffer is empty");
+        }
+
+        return this->_get();
+    }
+
+    bool try_get(T& value)
+    {
+        std::unique_lock<Lock> lock(_mutex, std::try_to_lock);
+
+        if (!lock.owns_lock() || this->_size() == 0)
+        {
+            return false;
+        }
+
+        value = this->_get();
+
+        return true;
+    }
+
+    // Blocks until the mapping has been written back to the file.
+    void sync()
+    {
+        std::lock_guard<Lock> lock(_mutex);
+
+        if (_header != nullptr && msync(_header, _mapping_size, MS_SYNC) == -1)
+        {
+            throw std::system_error(errno, std::generic_category(), "msync");
+        }
+    }
+
+private :
+    static constexpr uint64_t magic = 0x4655424352494331; // "1CIRCBUF"
+    static constexpr uint32_t version = 1;
+
+    struct alignas(circular_buffer_cache_line_size) header
+    {
+        std::atomic<uint64_t> magic;
+        uint32_t version;
+        uint32_t element_size;
+        uint64_t buffer_size;
+        std::atomic<uint64_t> start;
+        std::atomic<uint64_t> end;
+    };
+
+    static constexpr size_t buffer_offset =
+        (sizeof(header) + alignof(T) - 1) / alignof(T) * alignof(T);
+
+    header* _header;
+    T* _buffer;
+    size_t _buffer_size;
+    size_t _mapping_size;
+    mutable Lock _mutex;
+
+    mapped_circular_buffer() noexcept :
+        _header(nullptr), _buffer(nullptr), _buffer_size(0), _mapping_size(0)
+    { }
+
+    void open(const std::string& path, int flags, size_t buffer_size)
+    {
+        const int fd = ::open(path.c_str(), flags | O_CLOEXEC, 0644);
+
+        if (fd == -1)
+        {
+            throw std::system_error(errno, std::generic_category(), path);
+        }
+
+        try
+        {
+            this->map(fd, buffer_size);
+        }
+        catch (...)
+        {
+            close(fd);
+            throw;
+        }
+
+        close(fd);
+    }
+
+    void map(int fd, size_t buffer_size)
+    {
+        struct stat st;
+
+        if (fstat(fd, &st) == -1)
+        {
+            throw std::system_error(errno, std::generic_category(), "fstat");
+        }
+
+        bool created = false;
+
+        if (st.st_size == 0)
+        {
+            if (buffer_size == 0)
+            {
+                throw std::runtime_error("invalid circular buffer file");
+            }
+
+            _mapping_size = buffer_offset + buffer_size * sizeof(T);
+
+            if (ftruncate(fd, _mapping_size) == -1)
+            {
+                throw std::system_error(errno, std::generic_category(),
+                                        "ftruncate");
+            }
+
+            created = true;
+        }
+        else if (static_cast<size_t>(st.st_size) < sizeof(header)
+                 || this->read_magic(fd) != magic)
+        {
+            throw std::runtime_error("invalid circular buffer file");
+        }
+        else
+        {
+            _mapping_size = st.st_size;
+        }
+
+        void* area = mmap(nullptr, _mapping_size, PROT_READ | PROT_WRITE,
+                          MAP_SHARED, fd, 0);
+
+        if (area == MAP_FAILED)
+        {
+            throw std::system_error(errno, std::generic_category(), "mmap");
+        }
+
+        _header = static_cast<header*>(area);
+        _buffer = reinterpret_cast<T*>(static_cast<char*>(area)
+                                       + buffer_offset);
+
+        if (created)
+        {
+            // The magic is published last so that a crash in between leaves
+            // a file that is rejected rather than garbage indices.
+            _header->version = version;
+            _header->element_size = sizeof(T);
+            _header->buffer_size = buffer_size;
+            _header->start.store(0, std::memory_order_relaxed);
+            _header->end.store(0, std::memory_order_relaxed);
+            _header->magic.store(magic, std::memory_order_release);
+        }
+        else if (_header->version != version
+                 || _header->element_size != sizeof(T)
+                 || _mapping_size < buffer_offset
+                 || _header->buffer_size
+                    > (_mapping_size - buffer_offset) / sizeof(T)
+                 || _header->end.load() - _header->start.load()
+                    > _header->buffer_size)
+        {
+            this->unmap();
+
+            throw std::runtime_error("invalid circular buffer file");
+        }
+
+        _buffer_size = _header->buffer_size;
+    }
+
+    static uint64_t read_magic(int fd)
+    {
+        uint64_t value = 0;
+
+        if (pread(fd, &value, sizeof(value), 0) != sizeof(value))
+        {
+            return 0;
+        }
+
+        return value;
+    }
+
+    void unmap() noexcept
+    {
+        if (_header != nullptr)
+        {
+            munmap(_header, _mapping_size);
+        }
+
+        _header = nullptr;
+        _buffer = nullptr;
+        _buffer_size = 0;
+        _mapping_size = 0;
+    }
+
+    void mcb_move(mapped_circular_buffer&& other) noexcept
+    {
+        this->unmap();
+
+        _header = std::exchange(other._header, nullptr);
+        _buffer = std::exchange(other._buffer, nullptr);
+        _buffer_size = std::exchange(other._buffer_size, 0);
+        _mapping_size = std::exchange(other._mapping_size, 0);
+    }
+
+    size_t _size() const noexcept
+    {
+        if (_header == nullptr)
+        {
+            return 0;
+        }
+
+        return _header->end.load(std::memory_order_acquire)
+            - _header->start.load(std::memory_order_acquire);
+    }
+
+    T _get() noexcept
+    {
+        const uint64_t start = _header->start.load(std::memory_order_relaxed);
+        T value;
+
+        std::memcpy(&value, _buffer + start % _buffer_size, sizeof(T));
+        _header->start.store(start + 1, std::memory_order_release);
+
+        return value;
+    }
+};
+
+#endif
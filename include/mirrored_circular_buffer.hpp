@@ -0,0 +1,359 @@
+#ifndef MIRRORED_CIRCULAR_BUFFER_HPP_
+# define MIRRORED_CIRCULAR_BUFFER_HPP_
+
+# include <mutex>
+# include <span>
+# include <utility>
+# include <algorithm>
+# include <stdexcept>
+# include <system_error>
+# include <cerrno>
+# include <cstring>
+# include <cstddef>
+
+# include <sys/mman.h>
+# include <unistd.h>
+
+# include "circular_buffer_common.hpp"
+
+// Byte circular buffer (Linux) whose storage is mapped twice back to back,
+// so the bytes following the end of the storage are the ones at its start :
+// the readable and writable windows are always one contiguous range, no
+// matter where they wrap. The capacity is rounded up to a multiple of the
+// page size. As with array_circular_buffer, add overwrites the oldest bytes
+// when the buffer is full.
+template <typename Lock = std::mutex>
+class mirrored_circular_buffer
+{
+public :
+    mirrored_circular_buffer() noexcept :
+        _buffer_size(0), _buffer(nullptr), _start(0), _end(0), _full(false)
+    { }
+
+    mirrored_circular_buffer(size_t buffer_size) :
+        _buffer_size(round_to_page(buffer_size)),
+        _buffer(map(_buffer_size)),
+        _start(0),
+        _end(0),
+        _full(false)
+    { }
+
+    mirrored_circular_buffer(const mirrored_circular_buffer&) = delete;
+    mirrored_circular_buffer& operator=(const mirrored_circular_buffer&) =
+        delete;
+
+    mirrored_circular_buffer(mirrored_circular_buffer&& other) :
+        mirrored_circular_buffer()
+    {
+        std::lock_guard<Lock> lock(other._mutex);
+
+        this->mcb_move(std::move(other));
+    }
+
+    mirrored_circular_buffer& operator=(mirrored_circular_buffer&& other)
+    {
+        if (this != &other)
+        {
+            std::scoped_lock lock(other._mutex, _mutex);
+
+            this->mcb_move(std::move(other));
+        }
+
+        return *this;
+    }
+
+    ~mirrored_circular_buffer()
+    {
+        unmap(_buffer, _buffer_size);
+    }
+
+    size_t buffer_size() const
+    {
+        circular_buffer_read_lock<Lock> lock(_mutex);
+
+        return _buffer_size;
+    }
+
+    size_t size() const
+    {
+        circular_buffer_read_lock<Lock> lock(_mutex);
+
+        return this->_size();
+    }
+
+    bool is_empty() const
+    {
+        circular_buffer_read_lock<Lock> lock(_mutex);
+
+        return !_full && _start == _end;
+    }
+
+    bool is_full() const
+    {
+        circular_buffer_read_lock<Lock> lock(_mutex);
+
+        return _full;
+    }
+
+    void clear()
+    {
+        std::lock_guard<Lock> lock(_mutex);
+
+        _start = 0;
+        _end = 0;
+        _full = false;
+    }
+
+    mirrored_circular_buffer& add(char value)
+    {
+        return this->add(std::span<const char>(&value, 1));
+    }
+
+    // Only the last buffer_size() bytes are kept when data is bigger than
+    // the buffer.
+    mirrored_circular_buffer& add(std::span<const char> data)
+    {
+        std::lock_guard<Lock> lock(_mutex);
+
+        if (_buffer_size == 0)
+        {
+            throw std::out_of_range(
+                      "circular buffer doesn't have space memory to store");
+        }
+
+        if (data.size() > _buffer_size)
+        {
+            data = data.last(_buffer_size);
+        }
+
+        if (!data.empty())
+        {
+            std::memcpy(_buffer + _end, data.data(), data.size());
+            this->post_add(data.size());
+        }
+
+        return *this;
+    }
+
+    char get()
+    {
+        std::lock_guard<Lock> lock(_mutex);
+
+        if (!_full && _start == _end)
+        {
+            throw std::out_of_range("circular buffer is empty");
+        }
+
+        char value = _buffer[_start];
+
+        this->post_get(1);
+
+        return value;
+    }
+
+    bool try_get(char& value)
+    {
+        std::unique_lock<Lock> lock(_mutex, std::try_to_lock);
+
+        if (!lock.owns_lock() || (!_full && _start == _end))
+        {
+            return false;
+        }
+
+        value = _buffer[_start];
+        this->post_get(1);
+
+        return true;
+    }
+
+    // Copies up to data.size() of the oldest bytes into data and returns how
+    // many were retrieved.
+    size_t get(std::span<char> data)
+    {
+        std::lock_guard<Lock> lock(_mutex);
+
+        const size_t count = std::min(data.size(), this->_size());
+
+        if (count > 0)
+        {
+            std::memcpy(data.data(), _buffer + _start, count);
+            this->post_get(count);
+        }
+
+        return count;
+    }
+
+    // Zero-copy access, see array_circular_buffer : peek exposes every
+    // stored byte and prepare up to n free bytes, each as a single span.
+    std::span<char> peek()
+    {
+        std::lock_guard<Lock> lock(_mutex);
+
+        return std::span<char>(_buffer + _start, this->_size());
+    }
+
+    void consume(size_t n)
+    {
+        std::lock_guard<Lock> lock(_mutex);
+
+        if (n > this->_size())
+        {
+            throw std::out_of_range(
+                      "circular buffer doesn't have enough elements");
+        }
+
+        if (n > 0)
+        {
+            this->post_get(n);
+        }
+    }
+
+    std::span<char> prepare(size_t n)
+    {
+        std::lock_guard<Lock> lock(_mutex);
+
+        return std::span<char>(_buffer + _end,
+                               std::min(n, _buffer_size - this->_size()));
+    }
+
+    void commit(size_t n)
+    {
+        std::lock_guard<Lock> lock(_mutex);
+
+        if (n > _buffer_size - this->_size())
+        {
+            throw std::out_of_range("circular buffer doesn't have enough space");
+        }
+
+        if (n > 0)
+        {
+            this->post_add(n);
+        }
+    }
+
+private :
+    size_t _buffer_size;
+    char* _buffer;
+    size_t _start;
+    size_t _end;
+    bool _full;
+    mutable Lock _mutex;
+
+    static size_t round_to_page(size_t buffer_size)
+    {
+        const size_t page_size = sysconf(_SC_PAGESIZE);
+
+        return (buffer_size + page_size - 1) / page_size * page_size;
+    }
+
+    // Reserves twice the size of address space, then maps the same memfd
+    // over both halves.
+    static char* map(size_t buffer_size)
+    {
+        if (buffer_size == 0)
+        {
+            return nullptr;
+        }
+
+        const int fd = memfd_create("mirrored_circular_buffer", MFD_CLOEXEC);
+
+        if (fd == -1)
+        {
+            throw std::system_error(errno, std::generic_category(),
+                                    "memfd_create");
+        }
+
+        void* area = MAP_FAILED;
+
+        if (ftruncate(fd, buffer_size) == 0)
+        {
+            area = mmap(nullptr, 2 * buffer_size, PROT_NONE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        }
+
+        char* buffer = static_cast<char*>(area);
+
+        if (area == MAP_FAILED
+            || mmap(buffer, buffer_size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED
+            || mmap(buffer + buffer_size, buffer_size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED)
+        {
+            const int error = errno;
+
+            if (area != MAP_FAILED)
+            {
+                munmap(area, 2 * buffer_size);
+            }
+
+            close(fd);
+
+            throw std::system_error(error, std::generic_category(), "mmap");
+        }
+
+        close(fd);
+
+        return buffer;
+    }
+
+    static void unmap(char* buffer, size_t buffer_size) noexcept
+    {
+        if (buffer != nullptr)
+        {
+            munmap(buffer, 2 * buffer_size);
+        }
+    }
+
+    void mcb_move(mirrored_circular_buffer&& other) noexcept
+    {
+        unmap(_buffer, _buffer_size);
+
+        _buffer_size = std::exchange(other._buffer_size, 0);
+        _buffer = std::exchange(other._buffer, nullptr);
+        _start = std::exchange(other._start, 0);
+        _end = std::exchange(other._end, 0);
+        _full = std::exchange(other._full, false);
+    }
+
+    size_t _size() const noexcept
+    {
+        if (_full)
+        {
+            return _buffer_size;
+        }
+
+        return _end >= _start ? _end - _start : _buffer_size - _start + _end;
+    }
+
+    void post_add(size_t count) noexcept
+    {
+        const size_t size = this->_size();
+
+        _end += count;
+
+        if (_end >= _buffer_size)
+        {
+            _end -= _buffer_size;
+        }
+
+        if (size + count >= _buffer_size)
+        {
+            _start = _end;
+            _full = true;
+        }
+    }
+
+    void post_get(size_t count) noexcept
+    {
+        _start += count;
+
+        if (_start >= _buffer_size)
+        {
+            _start -= _buffer_size;
+        }
+
+        _full = false;
+    }
+};
+
+#endif
@@ -0,0 +1,220 @@
+#ifndef MPMC_CIRCULAR_BUFFER_HPP_
+# define MPMC_CIRCULAR_BUFFER_HPP_
+
+# include <atomic>
+# include <memory>
+# include <stdexcept>
+# include <cstddef>
+
+# include "circular_buffer_common.hpp"
+
+// Bounded lock-free circular buffer for any number of producers and
+// consumers (D. Vyukov's algorithm). Every slot carries a sequence number
+// telling whether it is ready to be written or read for a given cursor
+// position, so producers only contend on _end and consumers only on _start.
+// Adding to a full buffer fails instead of overwriting the oldest element.
+// The algorithm needs at least 2 slots : a buffer of size 1 gets 2 and
+// checks its size on add.
+template <typename T>
+class mpmc_circular_buffer
+{
+public :
+    mpmc_circular_buffer() : mpmc_circular_buffer(0) { }
+
+    mpmc_circular_buffer(size_t buffer_size) :
+        _buffer_size(buffer_size),
+        _cell_count(buffer_size == 1 ? 2 : buffer_size),
+        _buffer(std::make_unique<cell[]>(_cell_count)),
+        _end(0),
+        _start(0)
+    {
+        for (size_t n = 0; n < _cell_count; ++n)
+        {
+            _buffer[n].sequence.store(n, std::memory_order_relaxed);
+        }
+    }
+
+    mpmc_circular_buffer(const mpmc_circular_buffer&) = delete;
+    mpmc_circular_buffer& operator=(const mpmc_circular_buffer&) = delete;
+
+    size_t buffer_size() const noexcept
+    {
+        return _buffer_size;
+    }
+
+    // is_empty and is_full are only snapshots when other threads are active.
+    // _start is read first since it never overtakes _end.
+    bool is_empty() const noexcept
+    {
+        const size_t start = _start.load(std::memory_order_acquire);
+
+        return _end.load(std::memory_order_acquire) == start;
+    }
+
+    bool is_full() const noexcept
+    {
+        const size_t start = _start.load(std::memory_order_acquire);
+
+        return _end.load(std::memory_order_acquire) - start >= _buffer_size;
+    }
+
+    mpmc_circular_buffer& add(const T& value)
+    {
+        if (!this->try_add(value))
+        {
+            this->throw_full();
+        }
+
+        return *this;
+    }
+
+    mpmc_circular_buffer& add(T&& value)
+    {
+        if (!this->try_add(std::move(value)))
+        {
+            this->throw_full();
+        }
+
+        return *this;
+    }
+
+    bool try_add(const T& value)
+    {
+        return this->_try_add(value);
+    }
+
+    bool try_add(T&& value)
+    {
+        return this->_try_add(std::move(value));
+    }
+
+    T get()
+    {
+        T value;
+
+        if (!this->try_get(value))
+        {
+            throw std::out_of_range("circular buffer is empty");
+        }
+
+        return value;
+    }
+
+    bool try_get(T& value)
+    {
+        if (_buffer_size == 0)
+        {
+            return false;
+        }
+
+        size_t pos = _start.load(std::memory_order_relaxed);
+        cell* c;
+
+        while (1)
+        {
+            c = &_buffer[pos % _cell_count];
+
+            const size_t sequence = c->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence - (pos + 1));
+
+            if (diff == 0)
+            {
+                if (_start.compare_exchange_weak(pos, pos + 1,
+                                                 std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = _start.load(std::memory_order_relaxed);
+            }
+        }
+
+        value = std::move(c->value);
+        c->sequence.store(pos + _cell_count, std::memory_order_release);
+
+        return true;
+    }
+
+private :
+    struct cell
+    {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    const size_t _buffer_size;
+    const size_t _cell_count;
+    const std::unique_ptr<cell[]> _buffer;
+
+    alignas(circular_buffer_cache_line_size) std::atomic<size_t> _end;
+    alignas(circular_buffer_cache_line_size) std::atomic<size_t> _start;
+
+    [[noreturn]] void throw_full() const
+    {
+        if (_buffer_size == 0)
+        {
+            throw std::out_of_range(
+                      "circular buffer doesn't have space memory to store");
+        }
+
+        throw std::out_of_range("circular buffer is full");
+    }
+
+    template <typename U>
+    bool _try_add(U&& value)
+    {
+        if (_buffer_size == 0)
+        {
+            return false;
+        }
+
+        size_t pos = _end.load(std::memory_order_relaxed);
+        cell* c;
+
+        while (1)
+        {
+            c = &_buffer[pos % _cell_count];
+
+            const size_t sequence = c->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence - pos);
+
+            if (diff == 0)
+            {
+                // _start may only be stale towards a fuller buffer.
+                if (_cell_count != _buffer_size &&
+                    pos - _start.load(std::memory_order_acquire) >=
+                    _buffer_size)
+                {
+                    return false;
+                }
+
+                if (_end.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = _end.load(std::memory_order_relaxed);
+            }
+        }
+
+        c->value = std::forward<U>(value);
+        c->sequence.store(pos + 1, std::memory_order_release);
+
+        return true;
+    }
+};
+
+#endif
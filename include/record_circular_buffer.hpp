@@ -0,0 +1,295 @@
+#ifndef RECORD_CIRCULAR_BUFFER_HPP_
+# define RECORD_CIRCULAR_BUFFER_HPP_
+
+# include <memory>
+# include <mutex>
+# include <span>
+# include <optional>
+# include <stdexcept>
+# include <cstring>
+# include <cstdint>
+# include <cstddef>
+
+# include "circular_buffer_common.hpp"
+
+// Circular buffer of variable-length records stored in place in a single
+// byte arena, each behind an 8 bytes length prefix and padded to 8 bytes.
+// A record never wraps : when it doesn't fit before the end of the arena,
+// the remaining bytes are skipped with a padding marker and the record
+// starts over at the beginning. Writing goes through reserve, which exposes
+// the record bytes, and commit, which publishes them; reading through peek,
+// which exposes the oldest record, and pop, which releases it. Only one
+// reservation may be pending at a time, and a peeked record stays valid
+// until it is popped. Records are rejected, never overwritten, when there
+// isn't enough room.
+template <typename Lock = std::mutex>
+class record_circular_buffer
+{
+public :
+    record_circular_buffer() noexcept :
+        _buffer_size(0), _start(0), _end(0), _count(0)
+    { }
+
+    // The size is rounded up to a multiple of 8 bytes.
+    record_circular_buffer(size_t buffer_size) :
+        _buffer_size(align(buffer_size)),
+        _buffer(std::make_unique<std::byte[]>(_buffer_size)),
+        _start(0),
+        _end(0),
+        _count(0)
+    { }
+
+    record_circular_buffer(const record_circular_buffer&) = delete;
+    record_circular_buffer& operator=(const record_circular_buffer&) = delete;
+
+    size_t buffer_size() const
+    {
+        circular_buffer_read_lock<Lock> lock(_mutex);
+
+        return _buffer_size;
+    }
+
+    // Number of records stored.
+    size_t size() const
+    {
+        circular_buffer_read_lock<Lock> lock(_mutex);
+
+        return _count;
+    }
+
+    bool is_empty() const
+    {
+        circular_buffer_read_lock<Lock> lock(_mutex);
+
+        return _count == 0;
+    }
+
+    void clear()
+    {
+        std::lock_guard<Lock> lock(_mutex);
+
+        _start = _end;
+        _count = 0;
+        _reservation.reset();
+    }
+
+    // Exposes size bytes for the next record, throwing when they don't fit.
+    std::span<std::byte> reserve(size_t size)
+    {
+        std::lock_guard<Lock> lock(_mutex);
+
+        if (!this->_reserve(size))
+        {
+            this->throw_no_room();
+        }
+
+        return this->reserved_bytes();
+    }
+
+    // Publishes the first size bytes of the pending reservation as a record.
+    void commit(size_t size)
+    {
+        std::lock_guard<Lock> lock(_mutex);
+
+        if (!_reservation || size > _reservation->size)
+        {
+            throw std::out_of_range("circular buffer doesn't have enough space");
+        }
+
+        this->_commit(size);
+    }
+
+    record_circular_buffer& add(std::span<const std::byte> record)
+    {
+        std::lock_guard<Lock> lock(_mutex);
+
+        if (!this->_add(record))
+        {
+            this->throw_no_room();
+        }
+
+        return *this;
+    }
+
+    bool try_add(std::span<const std::byte> record)
+    {
+        std::lock_guard<Lock> lock(_mutex);
+
+        return this->_add(record);
+    }
+
+    // The oldest record, if any.
+    std::optional<std::span<std::byte>> peek()
+    {
+        std::lock_guard<Lock> lock(_mutex);
+
+        if (_count == 0)
+        {
+            return std::nullopt;
+        }
+
+        this->skip_padding();
+
+        return std::span<std::byte>(this->record_bytes(_start),
+                                    this->read_header(_start));
+    }
+
+    void pop()
+    {
+        std::lock_guard<Lock> lock(_mutex);
+
+        if (_count == 0)
+        {
+            throw std::out_of_range("circular buffer is empty");
+        }
+
+        this->skip_padding();
+
+        _start += align(header_size + this->read_header(_start));
+        _count -= 1;
+    }
+
+private :
+    static constexpr size_t alignment = 8;
+    static constexpr size_t header_size = sizeof(uint64_t);
+    static constexpr uint64_t padding = UINT64_MAX;
+
+    struct reservation
+    {
+        uint64_t start;
+        size_t size;
+    };
+
+    // _start and _end only ever grow, the arena position being their value
+    // modulo the size.
+    size_t _buffer_size;
+    std::unique_ptr<std::byte[]> _buffer;
+    uint64_t _start;
+    uint64_t _end;
+    size_t _count;
+    std::optional<reservation> _reservation;
+    mutable Lock _mutex;
+
+    static constexpr size_t align(size_t size) noexcept
+    {
+        return (size + alignment - 1) & ~(alignment - 1);
+    }
+
+    size_t position(uint64_t index) const noexcept
+    {
+        return index % _buffer_size;
+    }
+
+    std::byte* record_bytes(uint64_t index) const noexcept
+    {
+        return _buffer.get() + this->position(index) + header_size;
+    }
+
+    std::span<std::byte> reserved_bytes() const noexcept
+    {
+        return std::span<std::byte>(this->record_bytes(_reservation->start),
+                                    _reservation->size);
+    }
+
+    uint64_t read_header(uint64_t index) const noexcept
+    {
+        uint64_t value;
+
+        std::memcpy(&value, _buffer.get() + this->position(index),
+                    header_size);
+
+        return value;
+    }
+
+    void write_header(uint64_t index, uint64_t value) noexcept
+    {
+        std::memcpy(_buffer.get() + this->position(index), &value,
+                    header_size);
+    }
+
+    [[noreturn]] void throw_no_room() const
+    {
+        if (_buffer_size == 0)
+        {
+            throw std::out_of_range(
+                      "circular buffer doesn't have space memory to store");
+        }
+
+        throw std::out_of_range("circular buffer doesn't have enough space");
+    }
+
+    // Finds room for a record of size bytes after the newest one, skipping
+    // the end of the arena when the record doesn't fit there. An empty
+    // buffer starts over at the beginning of the arena.
+    bool _reserve(size_t size)
+    {
+        if (_buffer_size == 0 || size > _buffer_size)
+        {
+            return false;
+        }
+
+        if (_count == 0 && this->position(_end) != 0)
+        {
+            _end += _buffer_size - this->position(_end);
+            _start = _end;
+        }
+
+        const size_t total = align(header_size + size);
+        const size_t tail = _buffer_size - this->position(_end);
+        const size_t skipped = total > tail ? tail : 0;
+
+        if (skipped + total > _buffer_size - (_end - _start))
+        {
+            return false;
+        }
+
+        _reservation = reservation{ _end + skipped, size };
+
+        return true;
+    }
+
+    // The padding, if any, is only written once the record is committed.
+    void _commit(size_t size) noexcept
+    {
+        const uint64_t start = _reservation->start;
+
+        if (start != _end)
+        {
+            this->write_header(_end, padding);
+        }
+
+        this->write_header(start, size);
+
+        _end = start + align(header_size + size);
+        _count += 1;
+        _reservation.reset();
+    }
+
+    bool _add(std::span<const std::byte> record)
+    {
+        if (!this->_reserve(record.size()))
+        {
+            return false;
+        }
+
+        if (!record.empty())
+        {
+            std::memcpy(this->reserved_bytes().data(), record.data(),
+                        record.size());
+        }
+
+        this->_commit(record.size());
+
+        return true;
+    }
+
+    void skip_padding() noexcept
+    {
+        if (this->read_header(_start) == padding)
+        {
+            _start += _buffer_size - this->position(_start);
+        }
+    }
+};
+
+#endif
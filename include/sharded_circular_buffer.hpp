@@ -0,0 +1,179 @@
+#ifndef SHARDED_CIRCULAR_BUFFER_HPP_
+# define SHARDED_CIRCULAR_BUFFER_HPP_
+
+# include <atomic>
+# include <memory>
+# include <mutex>
+# include <span>
+# include <thread>
+# include <algorithm>
+# include <stdexcept>
+# include <cstddef>
+
+# include "circular_buffer_common.hpp"
+# include "array_circular_buffer.hpp"
+
+// Set of array_circular_buffer shards, one per thread slot, for many
+// producers that don't need a global FIFO order. Each thread adds to its
+// own shard and gets from it first, stealing from the other shards when it
+// is empty, so threads only contend when they share a slot or steal. Order
+// is preserved per shard only, and each shard applies Policy on its own.
+template <typename T,
+          full_policy Policy = full_policy::overwrite,
+          typename Lock = std::mutex>
+class sharded_circular_buffer
+{
+public :
+    using shard_type = array_circular_buffer<T, Policy, Lock>;
+
+    sharded_circular_buffer(size_t shard_buffer_size,
+                            size_t shard_count = default_shard_count()) :
+        _shard_count(std::max<size_t>(shard_count, 1)),
+        _shards(std::make_unique<shard[]>(_shard_count))
+    {
+        for (size_t n = 0; n < _shard_count; ++n)
+        {
+            _shards[n].buffer.resize(shard_buffer_size);
+        }
+    }
+
+    sharded_circular_buffer(const sharded_circular_buffer&) = delete;
+    sharded_circular_buffer& operator=(const sharded_circular_buffer&) =
+        delete;
+
+    size_t shard_count() const noexcept
+    {
+        return _shard_count;
+    }
+
+    shard_type& local_shard() noexcept
+    {
+        return _shards[this->local_index()].buffer;
+    }
+
+    // Total capacity of the shards.
+    size_t buffer_size() const
+    {
+        return _shards[0].buffer.buffer_size() * _shard_count;
+    }
+
+    // Sum of the shard sizes, each read under its own lock : only a
+    // snapshot while other threads are adding or getting.
+    size_t size() const
+    {
+        size_t size = 0;
+
+        for (size_t n = 0; n < _shard_count; ++n)
+        {
+            size += _shards[n].buffer.size();
+        }
+
+        return size;
+    }
+
+    bool is_empty() const
+    {
+        for (size_t n = 0; n < _shard_count; ++n)
+        {
+            if (!_shards[n].buffer.is_empty())
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    void clear()
+    {
+        for (size_t n = 0; n < _shard_count; ++n)
+        {
+            _shards[n].buffer.clear();
+        }
+    }
+
+    sharded_circular_buffer& add(const T& value)
+    {
+        this->local_shard().add(value);
+
+        return *this;
+    }
+
+    sharded_circular_buffer& add(T&& value)
+    {
+        this->local_shard().add(std::move(value));
+
+        return *this;
+    }
+
+    bool try_add(const T& value)
+    {
+        return this->local_shard().try_add(value);
+    }
+
+    bool try_add(T&& value)
+    {
+        return this->local_shard().try_add(std::move(value));
+    }
+
+    T get()
+    {
+        T value;
+        const size_t local = this->local_index();
+
+        for (size_t n = 0; n < _shard_count; ++n)
+        {
+            auto& buffer = _shards[(local + n) % _shard_count].buffer;
+
+            if (buffer.get_n(std::span<T>(&value, 1)) == 1)
+            {
+                return value;
+            }
+        }
+
+        throw std::out_of_range("circular buffer is empty");
+    }
+
+    // Shards that are locked by another thread are skipped.
+    bool try_get(T& value)
+    {
+        const size_t local = this->local_index();
+
+        for (size_t n = 0; n < _shard_count; ++n)
+        {
+            if (_shards[(local + n) % _shard_count].buffer.try_get(value))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    static size_t default_shard_count() noexcept
+    {
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+
+private :
+    struct shard
+    {
+        alignas(circular_buffer_cache_line_size) shard_type buffer;
+    };
+
+    const size_t _shard_count;
+    const std::unique_ptr<shard[]> _shards;
+
+    // Threads are numbered in the order they first use a sharded buffer, so
+    // up to shard_count() threads get a shard of their own.
+    size_t local_index() const noexcept
+    {
+        static std::atomic<size_t> next_thread = 0;
+        thread_local const size_t thread =
+            next_thread.fetch_add(1, std::memory_order_relaxed);
+
+        return thread % _shard_count;
+    }
+};
+
+#endif
@@ -0,0 +1,321 @@
+#ifndef SHARED_CIRCULAR_BUFFER_HPP_
+# define SHARED_CIRCULAR_BUFFER_HPP_
+
+# include <atomic>
+# include <string>
+# include <type_traits>
+# include <stdexcept>
+# include <system_error>
+# include <cerrno>
+# include <cstring>
+# include <cstdint>
+# include <cstddef>
+
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+
+# include "circular_buffer_common.hpp"
+
+// Circular buffer living in a named POSIX shared memory segment, for one
+// producer and one consumer in separate processes. It follows the
+// spsc_circular_buffer protocol : the indices are lock-free atomics on
+// their own cache lines in the segment, and each handle keeps its cached
+// view of the other side's index locally. One process creates the segment,
+// the other attaches to it once it exists; the segment outlives both until
+// remove is called. Since the other process can write anything to the
+// segment, indices read from it are checked before being used, and an
+// invalid one throws.
+template <typename T>
+class shared_circular_buffer
+{
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "shared circular buffer elements must be trivially copyable");
+    static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+public :
+    // Creates the segment name with room for buffer_size elements; fails if
+    // it already exists.
+    shared_circular_buffer(const std::string& name, size_t buffer_size) :
+        _segment(nullptr),
+        _buffer(nullptr),
+        _buffer_size(buffer_size),
+        _slots(buffer_size + 1),
+        _start_cache(0),
+        _end_cache(0)
+    {
+        const int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+
+        if (fd == -1)
+        {
+            throw std::system_error(errno, std::generic_category(), name);
+        }
+
+        _mapping_size = buffer_offset + _slots * sizeof(T);
+
+        if (ftruncate(fd, _mapping_size) == -1)
+        {
+            const int error = errno;
+
+            close(fd);
+            shm_unlink(name.c_str());
+
+            throw std::system_error(error, std::generic_category(),
+                                    "ftruncate");
+        }
+
+        try
+        {
+            this->map(fd);
+        }
+        catch (...)
+        {
+            shm_unlink(name.c_str());
+            throw;
+        }
+
+        // The magic is published last, attaching before that fails.
+        _segment->version = version;
+        _segment->element_size = sizeof(T);
+        _segment->buffer_size = buffer_size;
+        _segment->end.store(0, std::memory_order_relaxed);
+        _segment->start.store(0, std::memory_order_relaxed);
+        _segment->magic.store(magic, std::memory_order_release);
+    }
+
+    // Attaches to the existing segment name.
+    explicit shared_circular_buffer(const std::string& name) :
+        _segment(nullptr),
+        _buffer(nullptr),
+        _buffer_size(0),
+        _slots(0),
+        _start_cache(0),
+        _end_cache(0)
+    {
+        const int fd = shm_open(name.c_str(), O_RDWR, 0);
+
+        if (fd == -1)
+        {
+            throw std::system_error(errno, std::generic_category(), name);
+        }
+
+        struct stat st;
+
+        if (fstat(fd, &st) == -1)
+        {
+            const int error = errno;
+
+            close(fd);
+
+            throw std::system_error(error, std::generic_category(), "fstat");
+        }
+
+        _mapping_size = st.st_size;
+
+        if (_mapping_size < buffer_offset)
+        {
+            close(fd);
+
+            throw std::runtime_error("invalid circular buffer segment");
+        }
+
+        this->map(fd);
+
+        if (_segment->magic.load(std::memory_order_acquire) != magic
+            || _segment->version != version
+            || _segment->element_size != sizeof(T)
+            || _segment->buffer_size
+               >= (_mapping_size - buffer_offset) / sizeof(T)
+            || _segment->start.load() > _segment->buffer_size
+            || _segment->end.load() > _segment->buffer_size)
+        {
+            munmap(_segment, _mapping_size);
+
+            throw std::runtime_error("invalid circular buffer segment");
+        }
+
+        _buffer_size = _segment->buffer_size;
+        _slots = _buffer_size + 1;
+        _start_cache = _segment->start.load(std::memory_order_acquire);
+        _end_cache = _segment->end.load(std::memory_order_acquire);
+    }
+
+    shared_circular_buffer(const shared_circular_buffer&) = delete;
+    shared_circular_buffer& operator=(const shared_circular_buffer&) = delete;
+
+    ~shared_circular_buffer()
+    {
+        munmap(_segment, _mapping_size);
+    }
+
+    // Removes the segment name; processes still attached keep using it.
+    // Returns false if it didn't exist.
+    static bool remove(const std::string& name)
+    {
+        if (shm_unlink(name.c_str()) == -1)
+        {
+            if (errno == ENOENT)
+            {
+                return false;
+            }
+
+            throw std::system_error(errno, std::generic_category(), name);
+        }
+
+        return true;
+    }
+
+    size_t buffer_size() const noexcept
+    {
+        return _buffer_size;
+    }
+
+    bool is_empty() const noexcept
+    {
+        return _segment->start.load(std::memory_order_acquire)
+            == _segment->end.load(std::memory_order_acquire);
+    }
+
+    bool is_full() const noexcept
+    {
+        return this->next(_segment->end.load(std::memory_order_acquire))
+            == _segment->start.load(std::memory_order_acquire);
+    }
+
+    shared_circular_buffer& add(const T& value)
+    {
+        if (!this->try_add(value))
+        {
+            if (_buffer_size == 0)
+            {
+                throw std::out_of_range(
+                          "circular buffer doesn't have space memory to store");
+            }
+
+            throw std::out_of_range("circular buffer is full");
+        }
+
+        return *this;
+    }
+
+    bool try_add(const T& value)
+    {
+        const uint64_t end =
+            this->checked(_segment->end.load(std::memory_order_relaxed));
+        const uint64_t next = this->next(end);
+
+        if (next == _start_cache)
+        {
+            _start_cache = _segment->start.load(std::memory_order_acquire);
+
+            if (next == _start_cache)
+            {
+                return false;
+            }
+        }
+
+        std::memcpy(_buffer + end, &value, sizeof(T));
+        _segment->end.store(next, std::memory_order_release);
+
+        return true;
+    }
+
+    T get()
+    {
+        T value;
+
+        if (!this->try_get(value))
+        {
+            throw std::out_of_range("circular buffer is empty");
+        }
+
+        return value;
+    }
+
+    bool try_get(T& value)
+    {
+        const uint64_t start =
+            this->checked(_segment->start.load(std::memory_order_relaxed));
+
+        if (start == _end_cache)
+        {
+            _end_cache = _segment->end.load(std::memory_order_acquire);
+
+            if (start == _end_cache)
+            {
+                return false;
+            }
+        }
+
+        std::memcpy(&value, _buffer + start, sizeof(T));
+        _segment->start.store(this->next(start), std::memory_order_release);
+
+        return true;
+    }
+
+private :
+    static constexpr uint64_t magic = 0x4655424d48534331; // "1CSHMBUF"
+    static constexpr uint32_t version = 1;
+
+    // Layout shared by both processes. The producer only writes end and the
+    // consumer only writes start.
+    struct segment
+    {
+        std::atomic<uint64_t> magic;
+        uint32_t version;
+        uint32_t element_size;
+        uint64_t buffer_size;
+
+        alignas(circular_buffer_cache_line_size) std::atomic<uint64_t> end;
+        alignas(circular_buffer_cache_line_size) std::atomic<uint64_t> start;
+    };
+
+    static constexpr size_t buffer_offset =
+        (sizeof(segment) + alignof(T) - 1) / alignof(T) * alignof(T);
+
+    segment* _segment;
+    T* _buffer;
+    size_t _buffer_size;
+    size_t _slots;
+    size_t _mapping_size;
+
+    // Local to this handle : the last observed index of the other side.
+    uint64_t _start_cache;
+    uint64_t _end_cache;
+
+    void map(int fd)
+    {
+        void* area = mmap(nullptr, _mapping_size, PROT_READ | PROT_WRITE,
+                          MAP_SHARED, fd, 0);
+        const int error = errno;
+
+        close(fd);
+
+        if (area == MAP_FAILED)
+        {
+            throw std::system_error(error, std::generic_category(), "mmap");
+        }
+
+        _segment = static_cast<segment*>(area);
+        _buffer = reinterpret_cast<T*>(static_cast<char*>(area)
+                                       + buffer_offset);
+    }
+
+    uint64_t checked(uint64_t index) const
+    {
+        if (index >= _slots)
+        {
+            throw std::runtime_error("invalid circular buffer segment");
+        }
+
+        return index;
+    }
+
+    uint64_t next(uint64_t n) const noexcept
+    {
+        return ++n == _slots ? 0 : n;
+    }
+};
+
+#endif
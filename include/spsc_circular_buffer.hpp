@@ -0,0 +1,166 @@
+#ifndef SPSC_CIRCULAR_BUFFER_HPP_
+# define SPSC_CIRCULAR_BUFFER_HPP_
+
+# include <atomic>
+# include <memory>
+# include <stdexcept>
+# include <cstddef>
+
+# include "circular_buffer_common.hpp"
+
+// Lock-free circular buffer for exactly one producer thread (add, try_add)
+// and one consumer thread (get, try_get). Unlike array_circular_buffer it
+// never overwrites unread elements : adding to a full buffer fails.
+template <typename T>
+class spsc_circular_buffer
+{
+public :
+    spsc_circular_buffer() : spsc_circular_buffer(0) { }
+
+    spsc_circular_buffer(size_t buffer_size) :
+        _buffer_size(buffer_size),
+        _slots(buffer_size + 1),
+        _buffer(std::make_unique<T[]>(buffer_size + 1)),
+        _end(0),
+        _start_cache(0),
+        _start(0),
+        _end_cache(0)
+    { }
+
+    spsc_circular_buffer(const spsc_circular_buffer&) = delete;
+    spsc_circular_buffer& operator=(const spsc_circular_buffer&) = delete;
+
+    size_t buffer_size() const noexcept
+    {
+        return _buffer_size;
+    }
+
+    bool is_empty() const noexcept
+    {
+        return _start.load(std::memory_order_acquire)
+            == _end.load(std::memory_order_acquire);
+    }
+
+    bool is_full() const noexcept
+    {
+        return this->next(_end.load(std::memory_order_acquire))
+            == _start.load(std::memory_order_acquire);
+    }
+
+    spsc_circular_buffer& add(const T& value)
+    {
+        if (!this->try_add(value))
+        {
+            this->throw_full();
+        }
+
+        return *this;
+    }
+
+    spsc_circular_buffer& add(T&& value)
+    {
+        if (!this->try_add(std::move(value)))
+        {
+            this->throw_full();
+        }
+
+        return *this;
+    }
+
+    bool try_add(const T& value)
+    {
+        return this->_try_add(value);
+    }
+
+    bool try_add(T&& value)
+    {
+        return this->_try_add(std::move(value));
+    }
+
+    T get()
+    {
+        T value;
+
+        if (!this->try_get(value))
+        {
+            throw std::out_of_range("circular buffer is empty");
+        }
+
+        return value;
+    }
+
+    bool try_get(T& value)
+    {
+        const size_t start = _start.load(std::memory_order_relaxed);
+
+        if (start == _end_cache)
+        {
+            _end_cache = _end.load(std::memory_order_acquire);
+
+            if (start == _end_cache)
+            {
+                return false;
+            }
+        }
+
+        value = std::move(_buffer[start]);
+        _start.store(this->next(start), std::memory_order_release);
+
+        return true;
+    }
+
+private :
+    // Read-only after construction, shared by both sides.
+    const size_t _buffer_size;
+    const size_t _slots;
+    const std::unique_ptr<T[]> _buffer;
+
+    // Producer side : _end is published to the consumer, _start_cache is the
+    // last observed consumer position so most adds touch no shared line.
+    alignas(circular_buffer_cache_line_size) std::atomic<size_t> _end;
+    size_t _start_cache;
+
+    // Consumer side, mirror of the producer side.
+    alignas(circular_buffer_cache_line_size) std::atomic<size_t> _start;
+    size_t _end_cache;
+
+    size_t next(size_t n) const noexcept
+    {
+        return ++n == _slots ? 0 : n;
+    }
+
+    [[noreturn]] void throw_full() const
+    {
+        if (_buffer_size == 0)
+        {
+            throw std::out_of_range(
+                      "circular buffer doesn't have space memory to store");
+        }
+
+        throw std::out_of_range("circular buffer is full");
+    }
+
+    template <typename U>
+    bool _try_add(U&& value)
+    {
+        const size_t end = _end.load(std::memory_order_relaxed);
+        const size_t next = this->next(end);
+
+        if (next == _start_cache)
+        {
+            _start_cache = _start.load(std::memory_order_acquire);
+
+            if (next == _start_cache)
+            {
+                return false;
+            }
+        }
+
+        _buffer[end] = std::forward<U>(value);
+        _end.store(next, std::memory_order_release);
+
+        return true;
+    }
+};
+
+#endif
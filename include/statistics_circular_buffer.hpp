@@ -0,0 +1,365 @@
+#ifndef STATISTICS_CIRCULAR_BUFFER_HPP_
+# define STATISTICS_CIRCULAR_BUFFER_HPP_
+
+# include <deque>
+# include <mutex>
+# include <utility>
+# include <algorithm>
+# include <cmath>
+# include <type_traits>
+# include <stdexcept>
+# include <cstdint>
+
+# include "circular_buffer_common.hpp"
+# include "array_circular_buffer.hpp"
+
+// Sliding window over the last buffer_size() values : add overwrites the
+// oldest value when full, as array_circular_buffer does, and the statistics
+// of the window are maintained as values enter and leave it, so that every
+// query is O(1). The minimum and maximum are the fronts of two monotonic
+// deques, which hold the values that may still become the extremum. The sum
+// of floating point values is compensated, and the variance comes from the
+// sum of squared deviations (Welford), updated as values enter and leave.
+template <typename T, typename Lock = std::mutex>
+class statistics_circular_buffer
+{
+    static_assert(std::is_arithmetic_v<T>,
+                  "statistics circular buffer elements must be arithmetic");
+
+public :
+    statistics_circular_buffer() noexcept :
+        _added(0), _evicted(0), _sum(0), _compensation(0), _m2(0)
+    { }
+
+    statistics_circular_buffer(size_t buffer_size) :
+        _buffer(buffer_size),
+        _added(0),
+        _evicted(0),
+        _sum(0),
+        _compensation(0),
+        _m2(0)
+    { }
+
+    statistics_circular_buffer(const statistics_circular_buffer& other)
+    {
+        std::lock_guard<Lock> lock(other._mutex);
+
+        this->scb_copy(other);
+    }
+
+    statistics_circular_buffer& operator=(
+        const statistics_circular_buffer& other)
+    {
+        if (this != &other)
+        {
+            std::scoped_lock lock(other._mutex, _mutex);
+
+            this->scb_copy(other);
+        }
+
+        return *this;
+    }
+
+    size_t buffer_size() const
+    {
+        circular_buffer_read_lock<Lock> lock(_mutex);
+
+        return _buffer.buffer_size();
+    }
+
+    size_t size() const
+    {
+        circular_buffer_read_lock<Lock> lock(_mutex);
+
+        return _buffer.size();
+    }
+
+    bool is_empty() const
+    {
+        circular_buffer_read_lock<Lock> lock(_mutex);
+
+        return _buffer.is_empty();
+    }
+
+    bool is_full() const
+    {
+        circular_buffer_read_lock<Lock> lock(_mutex);
+
+        return _buffer.is_full();
+    }
+
+    void clear()
+    {
+        std::lock_guard<Lock> lock(_mutex);
+
+        _buffer.clear();
+        _min.clear();
+        _max.clear();
+        this->reset_sums();
+    }
+
+    statistics_circular_buffer& add(T value)
+    {
+        std::lock_guard<Lock> lock(_mutex);
+
+        if (_buffer.is_full())
+        {
+            this->evict();
+        }
+
+        _buffer.add(value);
+
+        const size_t size = _buffer.size();
+        const double mean = size > 1 ? this->window_mean(size - 1) : 0.0;
+
+        this->add_to_sum(value);
+        _m2 += (value - mean) * (value - this->window_mean(size));
+
+        while (!_min.empty() && !(_min.back().first < value))
+        {
+            _min.pop_back();
+        }
+
+        while (!_max.empty() && !(value < _max.back().first))
+        {
+            _max.pop_back();
+        }
+
+        _min.emplace_back(value, _added);
+        _max.emplace_back(value, _added);
+        ++_added;
+
+        return *this;
+    }
+
+    T get()
+    {
+        std::lock_guard<Lock> lock(_mutex);
+
+        if (_buffer.is_empty())
+        {
+            throw std::out_of_range("circular buffer is empty");
+        }
+
+        this->evict();
+
+        return _buffer.get();
+    }
+
+    bool try_get(T& value)
+    {
+        std::unique_lock<Lock> lock(_mutex, std::try_to_lock);
+
+        if (!lock.owns_lock() || _buffer.is_empty())
+        {
+            return false;
+        }
+
+        this->evict();
+        value = _buffer.get();
+
+        return true;
+    }
+
+    circular_buffer_sum_t<T> sum() const
+    {
+        circular_buffer_read_lock<Lock> lock(_mutex);
+
+        return _sum + _compensation;
+    }
+
+    double mean() const
+    {
+        circular_buffer_read_lock<Lock> lock(_mutex);
+
+        this->check_not_empty();
+
+        return this->window_mean(_buffer.size());
+    }
+
+    // Population variance of the window.
+    double variance() const
+    {
+        circular_buffer_read_lock<Lock> lock(_mutex);
+
+        this->check_not_empty();
+
+        return std::max(0.0, _m2 / _buffer.size());
+    }
+
+    T min() const
+    {
+        circular_buffer_read_lock<Lock> lock(_mutex);
+
+        this->check_not_empty();
+
+        return _min.front().first;
+    }
+
+    T max() const
+    {
+        circular_buffer_read_lock<Lock> lock(_mutex);
+
+        this->check_not_empty();
+
+        return _max.front().first;
+    }
+
+private :
+    // Values of the monotonic deques are tagged with their position in the
+    // sequence of added values, to recognize them when they leave the window.
+    using entry = std::pair<T, uint64_t>;
+
+    array_circular_buffer<T, full_policy::overwrite, null_lock> _buffer;
+    std::deque<entry> _min;
+    std::deque<entry> _max;
+    uint64_t _added;
+    size_t _evicted;
+    circular_buffer_sum_t<T> _sum;
+    circular_buffer_sum_t<T> _compensation;
+    double _m2;
+    mutable Lock _mutex;
+
+    void scb_copy(const statistics_circular_buffer& other)
+    {
+        _buffer = other._buffer;
+        _min = other._min;
+        _max = other._max;
+        _added = other._added;
+        _evicted = other._evicted;
+        _sum = other._sum;
+        _compensation = other._compensation;
+        _m2 = other._m2;
+    }
+
+    void reset_sums() noexcept
+    {
+        _evicted = 0;
+        _sum = 0;
+        _compensation = 0;
+        _m2 = 0;
+    }
+
+    double window_mean(size_t size) const noexcept
+    {
+        return (static_cast<double>(_sum) + static_cast<double>(_compensation))
+               / size;
+    }
+
+    // Floating point values are summed with Neumaier's algorithm :
+    // _compensation gathers the low-order bits that _sum can't hold.
+    void accumulate(circular_buffer_sum_t<T> value) noexcept
+    {
+        const auto sum = _sum + value;
+
+        if (std::abs(_sum) >= std::abs(value))
+        {
+            _compensation += (_sum - sum) + value;
+        }
+        else
+        {
+            _compensation += (value - sum) + _sum;
+        }
+
+        _sum = sum;
+    }
+
+    void add_to_sum(T value) noexcept
+    {
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            this->accumulate(value);
+        }
+        else
+        {
+            _sum += value;
+        }
+    }
+
+    void remove_from_sum(T value) noexcept
+    {
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            this->accumulate(-value);
+        }
+        else
+        {
+            _sum -= value;
+        }
+    }
+
+    // Sums up the window again, without its first skipped values.
+    void recompute(size_t skipped)
+    {
+        const size_t size = _buffer.size() - skipped;
+
+        this->reset_sums();
+
+        for (size_t n = skipped; n < _buffer.size(); ++n)
+        {
+            this->add_to_sum(_buffer[n]);
+        }
+
+        if (size > 0)
+        {
+            const double mean = this->window_mean(size);
+
+            for (size_t n = skipped; n < _buffer.size(); ++n)
+            {
+                const double deviation = _buffer[n] - mean;
+
+                _m2 += deviation * deviation;
+            }
+        }
+    }
+
+    // Removes the oldest value of the window, still at the front of the
+    // buffer, from the statistics.
+    void evict()
+    {
+        const T value = _buffer.front();
+        const size_t size = _buffer.size() - 1;
+        const uint64_t oldest = _added - _buffer.size();
+        const double m2 = _m2;
+
+        if (size == 0)
+        {
+            this->reset_sums();
+        }
+        else
+        {
+            const double mean = this->window_mean(size + 1);
+
+            this->remove_from_sum(value);
+            _m2 -= (value - mean) * (value - this->window_mean(size));
+
+            // Removing most of the squared deviations leaves mostly rounding
+            // errors, which also pile up over time : the window is summed up
+            // again in both cases, which stays O(1) amortized.
+            if (_m2 < m2 * 0x1p-26 || ++_evicted >= _buffer.buffer_size())
+            {
+                this->recompute(1);
+            }
+        }
+
+        if (_min.front().second == oldest)
+        {
+            _min.pop_front();
+        }
+
+        if (_max.front().second == oldest)
+        {
+            _max.pop_front();
+        }
+    }
+
+    void check_not_empty() const
+    {
+        if (_buffer.is_empty())
+        {
+            throw std::out_of_range("circular buffer is empty");
+        }
+    }
+};
+
+#endif
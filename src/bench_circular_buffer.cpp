@@ -0,0 +1,280 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "array_circular_buffer.hpp"
+#include "list_circular_buffer.hpp"
+#include "spsc_circular_buffer.hpp"
+#include "mpmc_circular_buffer.hpp"
+#include "sharded_circular_buffer.hpp"
+
+namespace
+{
+    using bench_clock = std::chrono::steady_clock;
+
+    template <size_t N>
+    struct payload
+    {
+        char data[N];
+    };
+
+    struct result
+    {
+        double ops_per_sec;
+        std::vector<uint32_t> latencies;
+    };
+
+    uint32_t elapsed_ns(bench_clock::time_point start)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   bench_clock::now() - start).count();
+    }
+
+    uint32_t percentile(std::vector<uint32_t>& latencies, double p)
+    {
+        if (latencies.empty())
+        {
+            return 0;
+        }
+
+        auto nth = latencies.begin() + static_cast<size_t>(
+                       p * (latencies.size() - 1));
+
+        std::nth_element(latencies.begin(), nth, latencies.end());
+
+        return *nth;
+    }
+
+    void report(const char* name, size_t element_size, size_t capacity,
+                size_t producers, size_t consumers, result& r)
+    {
+        std::printf("%-8s %6zu %8zu %4zu %4zu %14.0f %8u %8u %8u\n",
+                    name, element_size, capacity, producers, consumers,
+                    r.ops_per_sec,
+                    percentile(r.latencies, 0.5),
+                    percentile(r.latencies, 0.99),
+                    percentile(r.latencies, 0.999));
+    }
+
+    // One thread alternating add and get : a first untimed pass measures the
+    // throughput, a second one times each call.
+    template <typename Buffer, typename T>
+    result run_single(size_t capacity, size_t ops)
+    {
+        Buffer buffer(capacity);
+        T value = { };
+        result r;
+
+        auto start = bench_clock::now();
+
+        for (size_t n = 0; n < ops; ++n)
+        {
+            buffer.try_add(value);
+            buffer.try_get(value);
+        }
+
+        const double seconds = std::chrono::duration<double>(
+                                   bench_clock::now() - start).count();
+
+        r.ops_per_sec = 2 * ops / seconds;
+        r.latencies.reserve(2 * ops);
+
+        for (size_t n = 0; n < ops; ++n)
+        {
+            auto op_start = bench_clock::now();
+
+            buffer.try_add(value);
+            r.latencies.push_back(elapsed_ns(op_start));
+
+            op_start = bench_clock::now();
+            buffer.try_get(value);
+            r.latencies.push_back(elapsed_ns(op_start));
+        }
+
+        return r;
+    }
+
+    // Producers and consumers hammering one buffer; only the successful
+    // calls are timed and counted.
+    template <typename Buffer, typename T>
+    result run_threads(size_t capacity, size_t ops,
+                       size_t producers, size_t consumers)
+    {
+        Buffer buffer(capacity);
+        const size_t per_producer = ops / producers;
+        const size_t total = per_producer * producers;
+        std::atomic<size_t> consumed(0);
+        std::atomic<bool> go(false);
+        std::vector<std::vector<uint32_t>> latencies(producers + consumers);
+        std::vector<std::thread> threads;
+
+        for (size_t p = 0; p < producers; ++p)
+        {
+            threads.emplace_back([&, p]()
+            {
+                auto& lat = latencies[p];
+                T value = { };
+
+                lat.reserve(per_producer);
+
+                while (!go.load())
+                {
+                    std::this_thread::yield();
+                }
+
+                for (size_t n = 0; n < per_producer; ++n)
+                {
+                    auto op_start = bench_clock::now();
+
+                    while (!buffer.try_add(value))
+                    {
+                        std::this_thread::yield();
+                        op_start = bench_clock::now();
+                    }
+
+                    lat.push_back(elapsed_ns(op_start));
+                }
+            });
+        }
+
+        for (size_t c = 0; c < consumers; ++c)
+        {
+            threads.emplace_back([&, c]()
+            {
+                auto& lat = latencies[producers + c];
+                T value;
+
+                lat.reserve(total / consumers);
+
+                while (!go.load())
+                {
+                    std::this_thread::yield();
+                }
+
+                while (consumed.load(std::memory_order_relaxed) < total)
+                {
+                    auto op_start = bench_clock::now();
+
+                    if (buffer.try_get(value))
+                    {
+                        lat.push_back(elapsed_ns(op_start));
+                        consumed.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    else
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+
+        auto start = bench_clock::now();
+
+        go.store(true);
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        const double seconds = std::chrono::duration<double>(
+                                   bench_clock::now() - start).count();
+        result r;
+
+        r.ops_per_sec = 2 * total / seconds;
+
+        for (auto& lat : latencies)
+        {
+            r.latencies.insert(r.latencies.end(), lat.begin(), lat.end());
+        }
+
+        return r;
+    }
+
+    template <typename T>
+    void bench_element(size_t capacity, size_t ops, size_t max_threads)
+    {
+        using array_t = array_circular_buffer<T, full_policy::reject>;
+        using list_t = list_circular_buffer<T, full_policy::reject>;
+        using spsc_t = spsc_circular_buffer<T>;
+        using mpmc_t = mpmc_circular_buffer<T>;
+        using sharded_t = sharded_circular_buffer<T, full_policy::reject>;
+
+        {
+            auto r = run_single<array_t, T>(capacity, ops);
+            report("array", sizeof(T), capacity, 0, 0, r);
+        }
+        {
+            auto r = run_single<list_t, T>(capacity, ops);
+            report("list", sizeof(T), capacity, 0, 0, r);
+        }
+        {
+            auto r = run_single<spsc_t, T>(capacity, ops);
+            report("spsc", sizeof(T), capacity, 0, 0, r);
+        }
+        {
+            auto r = run_single<mpmc_t, T>(capacity, ops);
+            report("mpmc", sizeof(T), capacity, 0, 0, r);
+        }
+
+        for (size_t threads = 1; threads <= max_threads; threads *= 2)
+        {
+            {
+                auto r = run_threads<array_t, T>(capacity, ops,
+                                                 threads, threads);
+                report("array", sizeof(T), capacity, threads, threads, r);
+            }
+            {
+                auto r = run_threads<list_t, T>(capacity, ops,
+                                                threads, threads);
+                report("list", sizeof(T), capacity, threads, threads, r);
+            }
+
+            if (threads == 1)
+            {
+                auto r = run_threads<spsc_t, T>(capacity, ops, 1, 1);
+                report("spsc", sizeof(T), capacity, 1, 1, r);
+            }
+
+            {
+                auto r = run_threads<mpmc_t, T>(capacity, ops,
+                                                threads, threads);
+                report("mpmc", sizeof(T), capacity, threads, threads, r);
+            }
+            {
+                auto r = run_threads<sharded_t, T>(capacity, ops,
+                                                   threads, threads);
+                report("sharded", sizeof(T), capacity, threads, threads, r);
+            }
+        }
+    }
+}
+
+// usage : bench_circular_buffer [ops] [max_threads]
+// Single-thread rows show 0 producers/consumers. Latencies are per call in
+// nanoseconds, clock overhead included; array and list use the reject
+// policy so that every element added is consumed exactly once.
+int main(int argc, char **argv)
+{
+    const size_t ops = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    const size_t hw = std::max(1u, std::thread::hardware_concurrency() / 2);
+    const size_t max_threads = argc > 2
+                             ? std::strtoul(argv[2], nullptr, 10) : hw;
+
+    std::printf("%-8s %6s %8s %4s %4s %14s %8s %8s %8s\n",
+                "impl", "size", "capacity", "prod", "cons",
+                "ops/sec", "p50", "p99", "p999");
+
+    for (size_t capacity : { 64, 4096 })
+    {
+        bench_element<payload<8>>(capacity, ops, max_threads);
+        bench_element<payload<64>>(capacity, ops, max_threads);
+        bench_element<payload<256>>(capacity, ops, max_threads);
+    }
+
+    return 0;
+}
@@ -1,5 +1,20 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <list>
+#include <span>
+#include <shared_mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <unistd.h>
+
 #include "array_circular_buffer.hpp"
 
 TEST(array_circular_buffer, test_1)
@@ -344,3 +359,907 @@ TEST(array_circular_buffer, test_4)
     EXPECT_EQ(acb2.get(), std::string("turtur"));
     EXPECT_EQ(acb2.get(), std::string("terter"));
 }
+
+TEST(array_circular_buffer, test_5)
+{
+    using namespace std::chrono_literals;
+
+    array_circular_buffer<int> acb(2);
+    int value = 42;
+
+    EXPECT_FALSE(acb.wait_get_for(value, 10ms));
+    EXPECT_EQ(value, 42);
+
+
+    std::thread producer([&acb]()
+    {
+        std::this_thread::sleep_for(20ms);
+        acb.add(1).add(2);
+    });
+
+    EXPECT_EQ(acb.wait_get(), 1);
+    EXPECT_TRUE(acb.wait_get_for(value, 1s));
+    EXPECT_EQ(value, 2);
+
+    producer.join();
+
+
+    acb.add(3).add(4);
+
+    std::thread consumer([&acb]()
+    {
+        std::this_thread::sleep_for(20ms);
+        EXPECT_EQ(acb.get(), 3);
+    });
+
+    acb.wait_add(5);
+
+    consumer.join();
+
+    EXPECT_TRUE(acb.is_full());
+    EXPECT_EQ(acb.get(), 4);
+    EXPECT_EQ(acb.get(), 5);
+    EXPECT_TRUE(acb.is_empty());
+}
+
+TEST(array_circular_buffer, test_6)
+{
+    array_circular_buffer<int> acb(5);
+    std::vector<int> values = { 1, 2, 3 };
+    std::array<int, 4> out = { };
+
+    acb.add_range(values);
+
+    EXPECT_FALSE(acb.is_full());
+    EXPECT_EQ(acb.get_n(std::span<int>(out).first(2)), 2u);
+    EXPECT_EQ(out[0], 1);
+    EXPECT_EQ(out[1], 2);
+
+
+    values = { 4, 5, 6, 7 };
+    acb.add_range(values.begin(), values.end());
+
+    EXPECT_TRUE(acb.is_full());
+    EXPECT_EQ(acb.get_n(out), 4u);
+    EXPECT_EQ(out, (std::array<int, 4>{ 3, 4, 5, 6 }));
+
+
+    values = { 8, 9, 10, 11, 12, 13, 14 };
+    acb.add_range(values);
+
+    EXPECT_TRUE(acb.is_full());
+    EXPECT_EQ(acb.get(), 10);
+    EXPECT_EQ(acb.get_n(out), 4u);
+    EXPECT_EQ(out, (std::array<int, 4>{ 11, 12, 13, 14 }));
+    EXPECT_TRUE(acb.is_empty());
+    EXPECT_EQ(acb.get_n(out), 0u);
+
+
+    std::list<int> list = { 15, 16, 17, 18, 19, 20 };
+    std::vector<int> result;
+
+    acb.add(0).add_range(list.begin(), list.end());
+
+    EXPECT_TRUE(acb.is_full());
+    EXPECT_EQ(acb.get_n(std::back_inserter(result), 10), 5u);
+    EXPECT_EQ(result, (std::vector<int>{ 16, 17, 18, 19, 20 }));
+}
+
+TEST(array_circular_buffer, test_7)
+{
+    using namespace std::literals::string_literals;
+
+    array_circular_buffer<std::string> acb(3);
+    std::vector<std::string> values = { "titi"s, "toto"s };
+    std::array<std::string, 3> out;
+
+    acb.add_range(values).add_range(values);
+
+    EXPECT_TRUE(acb.is_full());
+    EXPECT_EQ(acb.get_n(out), 3u);
+    EXPECT_EQ(out, (std::array<std::string, 3>{ "toto"s, "titi"s, "toto"s }));
+
+
+    array_circular_buffer<std::string> acb2;
+
+    EXPECT_NO_THROW(acb2.add_range(std::span<const std::string>()));
+
+    try
+    {
+        acb2.add_range(values);
+        FAIL() << "expected std::out_of_range";
+    }
+    catch (const std::out_of_range& e)
+    {
+        EXPECT_EQ(
+            e.what(),
+            std::string("circular buffer doesn't have space memory to store"));
+    }
+}
+
+TEST(array_circular_buffer, test_8)
+{
+    array_circular_buffer<int> acb(5);
+
+    {
+        auto segments = acb.peek();
+
+        EXPECT_TRUE(segments[0].empty());
+        EXPECT_TRUE(segments[1].empty());
+    }
+
+
+    auto writable = acb.prepare(3);
+
+    EXPECT_EQ(writable[0].size(), 3u);
+    EXPECT_TRUE(writable[1].empty());
+
+    writable[0][0] = 1;
+    writable[0][1] = 2;
+    writable[0][2] = 3;
+    acb.commit(3);
+
+    EXPECT_EQ(acb.get(), 1);
+    EXPECT_EQ(acb.get(), 2);
+
+
+    writable = acb.prepare(10);
+
+    EXPECT_EQ(writable[0].size(), 2u);
+    EXPECT_EQ(writable[1].size(), 2u);
+
+    writable[0][0] = 4;
+    writable[0][1] = 5;
+    writable[1][0] = 6;
+    writable[1][1] = 7;
+    acb.commit(4);
+
+    EXPECT_TRUE(acb.is_full());
+    EXPECT_TRUE(acb.prepare(1)[0].empty());
+
+
+    auto readable = acb.peek();
+
+    EXPECT_EQ(readable[0].size(), 3u);
+    EXPECT_EQ(readable[1].size(), 2u);
+    EXPECT_EQ(readable[0][0], 3);
+    EXPECT_EQ(readable[0][2], 5);
+    EXPECT_EQ(readable[1][1], 7);
+
+    acb.consume(4);
+
+    EXPECT_FALSE(acb.is_full());
+    EXPECT_EQ(acb.get(), 7);
+    EXPECT_TRUE(acb.is_empty());
+
+    try
+    {
+        acb.consume(1);
+        FAIL() << "expected std::out_of_range";
+    }
+    catch (const std::out_of_range& e)
+    {
+        EXPECT_EQ(e.what(),
+                  std::string("circular buffer doesn't have enough elements"));
+    }
+
+    try
+    {
+        acb.commit(6);
+        FAIL() << "expected std::out_of_range";
+    }
+    catch (const std::out_of_range& e)
+    {
+        EXPECT_EQ(e.what(),
+                  std::string("circular buffer doesn't have enough space"));
+    }
+}
+
+namespace
+{
+    struct tracked
+    {
+        static int alive;
+
+        int value;
+
+        explicit tracked(int value) : value(value) { ++alive; }
+        tracked(const tracked& other) : value(other.value) { ++alive; }
+        tracked(tracked&& other) : value(other.value) { ++alive; }
+        tracked& operator=(const tracked&) = default;
+        tracked& operator=(tracked&&) = default;
+        ~tracked() { --alive; }
+    };
+
+    int tracked::alive = 0;
+}
+
+TEST(array_circular_buffer, test_9)
+{
+    {
+        array_circular_buffer<tracked> acb(3);
+
+        EXPECT_EQ(tracked::alive, 0);
+
+        acb.add(tracked(1)).add(tracked(2));
+
+        EXPECT_EQ(tracked::alive, 2);
+
+        acb.add(tracked(3)).add(tracked(4));
+
+        EXPECT_EQ(tracked::alive, 3);
+        EXPECT_EQ(acb.get().value, 2);
+        EXPECT_EQ(tracked::alive, 2);
+
+
+        array_circular_buffer<tracked> acb2 = acb;
+
+        EXPECT_EQ(tracked::alive, 4);
+        EXPECT_EQ(acb2.get().value, 3);
+        EXPECT_EQ(tracked::alive, 3);
+
+
+        acb2 = std::move(acb);
+
+        EXPECT_EQ(tracked::alive, 2);
+
+
+        acb2.resize(5);
+
+        EXPECT_EQ(tracked::alive, 2);
+        EXPECT_EQ(acb2.get().value, 3);
+        EXPECT_EQ(acb2.get().value, 4);
+        EXPECT_EQ(tracked::alive, 0);
+
+
+        acb2.add(tracked(5)).add(tracked(6));
+        acb2.clear();
+
+        EXPECT_EQ(tracked::alive, 0);
+
+        acb2.add(tracked(7));
+    }
+
+    EXPECT_EQ(tracked::alive, 0);
+}
+
+TEST(array_circular_buffer, test_10)
+{
+    array_circular_buffer<int, full_policy::reject> acb(2);
+
+    EXPECT_TRUE(acb.try_add(1));
+    acb.add(2);
+
+    EXPECT_TRUE(acb.is_full());
+    EXPECT_FALSE(acb.try_add(3));
+
+    try
+    {
+        acb.add(3);
+        FAIL() << "expected std::out_of_range";
+    }
+    catch (const std::out_of_range& e)
+    {
+        EXPECT_EQ(e.what(), std::string("circular buffer is full"));
+    }
+
+    EXPECT_EQ(acb.get(), 1);
+    EXPECT_TRUE(acb.try_add(3));
+    EXPECT_EQ(acb.get(), 2);
+    EXPECT_EQ(acb.get(), 3);
+
+
+    acb.add(4).add(5);
+    acb.resize(1);
+
+    EXPECT_TRUE(acb.is_full());
+    EXPECT_EQ(acb.get(), 5);
+
+
+    using namespace std::chrono_literals;
+
+    array_circular_buffer<int, full_policy::block> acb2(2);
+
+    acb2.add(1).add(2);
+
+    EXPECT_FALSE(acb2.try_add(3));
+
+    std::thread consumer([&acb2]()
+    {
+        std::this_thread::sleep_for(20ms);
+        EXPECT_EQ(acb2.get(), 1);
+    });
+
+    acb2.add(3);
+
+    consumer.join();
+
+    EXPECT_EQ(acb2.get(), 2);
+    EXPECT_EQ(acb2.get(), 3);
+
+
+    array_circular_buffer<int> acb3(2);
+
+    EXPECT_TRUE(acb3.try_add(1));
+    EXPECT_TRUE(acb3.try_add(2));
+    EXPECT_TRUE(acb3.try_add(3));
+    EXPECT_EQ(acb3.get(), 2);
+    EXPECT_EQ(acb3.get(), 3);
+}
+
+TEST(array_circular_buffer, test_11)
+{
+    using namespace std::chrono_literals;
+
+    array_circular_buffer<int, full_policy::reject> acb(4);
+    std::vector<int> values = { 1, 2, 3 };
+    std::list<int> list = { 4, 5 };
+
+    acb.add_range(values);
+
+    try
+    {
+        acb.add_range(list.begin(), list.end());
+        FAIL() << "expected std::out_of_range";
+    }
+    catch (const std::out_of_range& e)
+    {
+        EXPECT_EQ(e.what(), std::string("circular buffer is full"));
+    }
+
+    EXPECT_FALSE(acb.is_full());
+    EXPECT_EQ(acb.get(), 1);
+
+
+    array_circular_buffer<int, full_policy::block> acb2(2);
+    std::vector<int> result;
+
+    std::thread consumer([&acb2, &result]()
+    {
+        while (result.size() < 5)
+        {
+            result.push_back(acb2.wait_get());
+        }
+    });
+
+    acb2.add_range(std::vector<int>{ 1, 2, 3 });
+    acb2.add_range(list.begin(), list.end());
+
+    consumer.join();
+
+    EXPECT_EQ(result, (std::vector<int>{ 1, 2, 3, 4, 5 }));
+    EXPECT_TRUE(acb2.is_empty());
+}
+
+template <typename Lock>
+static void array_lock_policy()
+{
+    array_circular_buffer<int, full_policy::overwrite, Lock> acb(3);
+
+    acb.add(1).add(2).add(3).add(4);
+
+    EXPECT_EQ(acb.buffer_size(), 3u);
+    EXPECT_TRUE(acb.is_full());
+    EXPECT_EQ(acb.get(), 2);
+
+
+    auto acb2 = acb;
+
+    acb2 = acb;
+    acb2 = std::move(acb);
+    acb2.resize(1);
+
+    EXPECT_EQ(acb2.get(), 4);
+    EXPECT_TRUE(acb2.is_empty());
+}
+
+TEST(array_circular_buffer, test_12)
+{
+    array_lock_policy<null_lock>();
+    array_lock_policy<spin_lock>();
+    array_lock_policy<std::mutex>();
+    array_lock_policy<std::recursive_mutex>();
+    array_lock_policy<std::shared_mutex>();
+
+    // Buffers that can't block carry no condition variable.
+    using unlocked = array_circular_buffer<int, full_policy::overwrite, null_lock>;
+    using locked = array_circular_buffer<int, full_policy::overwrite, spin_lock>;
+
+    EXPECT_TRUE(std::is_empty_v<circular_buffer_waiters<null_lock>>);
+    EXPECT_LT(sizeof(unlocked), sizeof(locked));
+
+
+    array_circular_buffer<int, full_policy::reject, spin_lock> acb(16);
+    std::thread producer([&acb]()
+    {
+        for (int n = 0; n < 10000; ++n)
+        {
+            while (!acb.try_add(n))
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    int value;
+
+    for (int n = 0; n < 10000; ++n)
+    {
+        while (!acb.try_get(value))
+        {
+            std::this_thread::yield();
+        }
+
+        EXPECT_EQ(value, n);
+    }
+
+    producer.join();
+}
+
+TEST(array_circular_buffer, test_13)
+{
+    array_circular_buffer<int> acb(5);
+
+    acb.add(1).add(2).add(3).add(4).add(5).add(6).add(7);
+    acb.resize(8);
+
+    EXPECT_FALSE(acb.is_full());
+
+    acb.add(8).add(9).add(10);
+
+    EXPECT_TRUE(acb.is_full());
+
+    acb.resize(3);
+
+    EXPECT_TRUE(acb.is_full());
+    EXPECT_EQ(acb.get(), 8);
+    EXPECT_EQ(acb.get(), 9);
+    EXPECT_EQ(acb.get(), 10);
+    EXPECT_TRUE(acb.is_empty());
+
+
+    using namespace std::literals::string_literals;
+
+    array_circular_buffer<std::string> acb2(3);
+
+    acb2.add("titi").add("toto").add("tutu").add("tata");
+
+    EXPECT_EQ(acb2.get(), "toto"s);
+
+    acb2.add("tete");
+    acb2.resize(6);
+    acb2.add("tartar");
+
+    EXPECT_FALSE(acb2.is_full());
+    EXPECT_EQ(acb2.get(), "tutu"s);
+
+    acb2.resize(2);
+
+    EXPECT_TRUE(acb2.is_full());
+    EXPECT_EQ(acb2.get(), "tete"s);
+    EXPECT_EQ(acb2.get(), "tartar"s);
+}
+
+TEST(array_circular_buffer, test_14)
+{
+    array_circular_buffer<int> acb(4);
+
+    EXPECT_EQ(acb.size(), 0u);
+    EXPECT_TRUE(acb.begin() == acb.end());
+
+    try
+    {
+        acb.front();
+        FAIL() << "expected std::out_of_range";
+    }
+    catch (const std::out_of_range& e)
+    {
+        EXPECT_EQ(e.what(), std::string("circular buffer is empty"));
+    }
+
+    acb.add(1).add(2).add(3).add(4).add(5).add(6);
+
+    EXPECT_EQ(acb.size(), 4u);
+    EXPECT_EQ(acb[0], 3);
+    EXPECT_EQ(acb[3], 6);
+    EXPECT_EQ(acb.at(1), 4);
+    EXPECT_EQ(acb.front(), 3);
+    EXPECT_EQ(acb.back(), 6);
+
+    try
+    {
+        acb.at(4);
+        FAIL() << "expected std::out_of_range";
+    }
+    catch (const std::out_of_range& e)
+    {
+        EXPECT_EQ(e.what(), std::string("circular buffer index out of range"));
+    }
+
+    EXPECT_EQ(acb.end() - acb.begin(), 4);
+    EXPECT_EQ(std::vector<int>(acb.begin(), acb.end()),
+              std::vector<int>({ 3, 4, 5, 6 }));
+    EXPECT_EQ(*std::max_element(acb.begin(), acb.end()), 6);
+    EXPECT_EQ(acb.end()[-2], 5);
+
+    for (int& value : acb)
+    {
+        value *= 10;
+    }
+
+    std::sort(acb.begin(), acb.end(), std::greater<int>());
+
+    const auto& cacb = acb;
+    array_circular_buffer<int>::const_iterator it = acb.begin();
+
+    EXPECT_TRUE(it == cacb.cbegin());
+    EXPECT_TRUE(it < cacb.cend());
+    EXPECT_EQ(*(it + 1), 50);
+    EXPECT_EQ(cacb.back(), 30);
+    EXPECT_EQ(acb.get(), 60);
+    EXPECT_EQ(acb.size(), 3u);
+}
+
+TEST(array_circular_buffer, test_15)
+{
+    array_circular_buffer<double> acb(1000);
+
+    try
+    {
+        acb.min();
+        FAIL() << "expected std::out_of_range";
+    }
+    catch (const std::out_of_range& e)
+    {
+        EXPECT_EQ(e.what(), std::string("circular buffer is empty"));
+    }
+
+    EXPECT_EQ(acb.sum(), 0.0);
+
+    // 1500 values so that the window wraps : 501 .. 1500 are kept.
+    for (int n = 1; n <= 1500; ++n)
+    {
+        acb.add(n % 2 ? n : -n);
+    }
+
+    EXPECT_EQ(acb.sum(), -500.0);
+    EXPECT_EQ(acb.mean(), -0.5);
+    EXPECT_EQ(acb.min(), -1500.0);
+    EXPECT_EQ(acb.max(), 1499.0);
+
+
+    array_circular_buffer<float> acb2(37);
+
+    for (int n = 0; n < 50; ++n)
+    {
+        acb2.add(n == 20 ? -3.0f : n * 0.5f);
+    }
+
+    EXPECT_FLOAT_EQ(acb2.sum(), 560.5f);
+    EXPECT_EQ(acb2.min(), -3.0f);
+    EXPECT_EQ(acb2.max(), 24.5f);
+
+
+    // float values are summed in double.
+    array_circular_buffer<float> acb4(1 << 20);
+
+    for (size_t n = 0; n < acb4.buffer_size(); ++n)
+    {
+        acb4.add(0.1f);
+    }
+
+    EXPECT_NEAR(acb4.sum(), (1 << 20) * static_cast<double>(0.1f), 1e-4);
+
+
+    array_circular_buffer<int8_t> acb3(200);
+
+    for (int n = 0; n < 200; ++n)
+    {
+        acb3.add(static_cast<int8_t>(n % 2 ? 100 : -7));
+    }
+
+    EXPECT_EQ(acb3.sum(), 9300);
+    EXPECT_EQ(acb3.min(), -7);
+    EXPECT_EQ(acb3.max(), 100);
+}
+
+TEST(array_circular_buffer, test_16)
+{
+    array_circular_buffer<int> acb(2);
+
+    acb.add(1).add(2).add(3);
+
+    EXPECT_EQ(acb.snapshot().adds, 0u);
+
+
+    array_circular_buffer<int, full_policy::overwrite, std::mutex,
+                          counting_stats> acb2(4);
+    int value;
+
+    EXPECT_FALSE(acb2.try_get(value));
+
+    acb2.add(1).add(2).add(3);
+    acb2.get();
+    acb2.add(4).add(5).add(6);
+
+    const std::array<int, 3> values = { 7, 8, 9 };
+
+    acb2.add_range(std::span<const int>(values));
+
+    EXPECT_EQ(acb2.get_n(std::span<int>(std::array<int, 2>().data(), 2)), 2u);
+    EXPECT_TRUE(acb2.try_get(value));
+    EXPECT_EQ(value, 8);
+
+    auto stats = acb2.snapshot();
+
+    EXPECT_EQ(stats.adds, 9u);
+    EXPECT_EQ(stats.gets, 4u);
+    EXPECT_EQ(stats.overwritten, 4u);
+    EXPECT_EQ(stats.try_get_empty, 1u);
+    EXPECT_EQ(stats.try_get_contended, 0u);
+    EXPECT_EQ(stats.peak_size, 4u);
+    EXPECT_EQ(stats.adds - stats.gets - stats.overwritten, acb2.size());
+}
+
+TEST(array_circular_buffer, test_17)
+{
+    array_circular_buffer<int> acb(5);
+    std::vector<int> seen;
+
+    EXPECT_EQ(acb.consume_all([&seen](int value) { seen.push_back(value); }),
+              0u);
+
+    acb.add(1).add(2).add(3).add(4).add(5).add(6).add(7);
+
+    EXPECT_EQ(acb.consume_up_to(2, [&seen](int& value)
+    {
+        seen.push_back(value);
+    }), 2u);
+    EXPECT_EQ(seen, std::vector<int>({ 3, 4 }));
+    EXPECT_EQ(acb.size(), 3u);
+
+    acb.add(8).add(9);
+
+    std::vector<size_t> segments;
+
+    seen.clear();
+
+    EXPECT_EQ(acb.consume_segments([&](std::span<int> values)
+    {
+        segments.push_back(values.size());
+        seen.insert(seen.end(), values.begin(), values.end());
+    }), 5u);
+    EXPECT_EQ(segments, std::vector<size_t>({ 1, 4 }));
+    EXPECT_EQ(seen, std::vector<int>({ 5, 6, 7, 8, 9 }));
+    EXPECT_TRUE(acb.is_empty());
+
+
+    array_circular_buffer<std::string> acb2(3);
+
+    acb2.add("titi").add("toto").add("tutu");
+
+    try
+    {
+        acb2.consume_all([](std::string& value)
+        {
+            if (value == "toto")
+            {
+                throw std::runtime_error("flush failed");
+            }
+        });
+        FAIL() << "expected std::runtime_error";
+    }
+    catch (const std::runtime_error&)
+    {
+    }
+
+    EXPECT_EQ(acb2.size(), 3u);
+
+    std::string concatenated;
+
+    acb2.consume_all([&concatenated](std::string& value)
+    {
+        concatenated += std::move(value);
+    });
+
+    EXPECT_EQ(concatenated, "tititototutu");
+    EXPECT_TRUE(acb2.is_empty());
+}
+
+TEST(array_circular_buffer, test_18)
+{
+    array_circular_buffer<int> acb(3);
+    const int fd = acb.event_fd();
+    uint64_t events;
+
+    EXPECT_EQ(acb.event_fd(), fd);
+    EXPECT_EQ(read(fd, &events, sizeof(events)), -1);
+
+    acb.add(1).add(2);
+
+    const std::array<int, 2> values = { 3, 4 };
+
+    acb.add_range(std::span<const int>(values));
+
+    EXPECT_EQ(read(fd, &events, sizeof(events)),
+              static_cast<ssize_t>(sizeof(events)));
+    EXPECT_EQ(events, 1u);
+
+    acb.get();
+    acb.add(5);
+    acb.consume(3);
+
+    EXPECT_EQ(read(fd, &events, sizeof(events)), -1);
+
+    acb.add(6);
+
+    EXPECT_EQ(read(fd, &events, sizeof(events)),
+              static_cast<ssize_t>(sizeof(events)));
+    EXPECT_EQ(events, 1u);
+
+
+    array_circular_buffer<int, full_policy::reject> acb2(2);
+    const int fd2 = acb2.event_fd(true);
+
+    acb2.add(1).add(2);
+
+    EXPECT_EQ(read(fd2, &events, sizeof(events)),
+              static_cast<ssize_t>(sizeof(events)));
+
+    acb2.get();
+    acb2.get();
+
+    EXPECT_EQ(read(fd2, &events, sizeof(events)),
+              static_cast<ssize_t>(sizeof(events)));
+    EXPECT_EQ(events, 1u);
+
+
+    array_circular_buffer<int, full_policy::reject> acb3 = std::move(acb2);
+
+    acb3.add(7);
+
+    EXPECT_EQ(read(fd2, &events, sizeof(events)),
+              static_cast<ssize_t>(sizeof(events)));
+}
+
+TEST(array_circular_buffer, test_19)
+{
+    array_circular_buffer<char> acb(8);
+    int fds[2];
+
+    ASSERT_EQ(pipe(fds), 0);
+
+    EXPECT_EQ(acb.write_to_fd(fds[1]), 0);
+
+    const std::string data = "titi toto";
+
+    ASSERT_EQ(write(fds[1], data.data(), data.size()),
+              static_cast<ssize_t>(data.size()));
+
+    // Only 8 bytes fit, the last one stays in the pipe.
+    EXPECT_EQ(acb.read_from_fd(fds[0]), 8);
+    EXPECT_TRUE(acb.is_full());
+    EXPECT_EQ(acb.read_from_fd(fds[0]), 0);
+
+    EXPECT_EQ(acb.get(), 't');
+    EXPECT_EQ(acb.get(), 'i');
+    EXPECT_EQ(acb.get(), 't');
+
+    // The free slots wrap around : bytes 0 to 2 of the storage.
+    EXPECT_EQ(acb.read_from_fd(fds[0], 3), 1);
+    EXPECT_EQ(acb.size(), 6u);
+
+    EXPECT_EQ(acb.write_to_fd(fds[1], 4), 4);
+    EXPECT_EQ(acb.size(), 2u);
+
+    ASSERT_EQ(write(fds[1], "!", 1), 1);
+
+    // The readable bytes wrap around as well.
+    EXPECT_EQ(acb.write_to_fd(fds[1]), 2);
+    EXPECT_TRUE(acb.is_empty());
+
+    char received[16] = { };
+
+    EXPECT_EQ(read(fds[0], received, sizeof(received)), 7);
+    EXPECT_EQ(std::string(received), "i to!to");
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST(array_circular_buffer, test_20)
+{
+    using namespace std::chrono_literals;
+
+    array_circular_buffer<int, full_policy::block> acb(1);
+
+    acb.add(1);
+
+    std::thread producer([&acb]()
+    {
+        EXPECT_THROW(acb.add(2), std::out_of_range);
+    });
+
+    std::this_thread::sleep_for(20ms);
+    acb.resize(0);
+    producer.join();
+
+
+    acb.resize(1);
+    acb.add(3);
+
+    std::thread waiter([&acb]()
+    {
+        EXPECT_THROW(acb.wait_add(4), std::out_of_range);
+    });
+
+    std::this_thread::sleep_for(20ms);
+    acb.resize(0);
+    waiter.join();
+
+    EXPECT_EQ(acb.buffer_size(), 0u);
+    EXPECT_TRUE(acb.is_empty());
+}
+
+TEST(array_circular_buffer, test_21)
+{
+    array_circular_buffer<int> acb(4);
+    size_t count = 0;
+    int sum = 0;
+
+    acb.add(1).add(2).add(3);
+
+    // Generic callbacks are called with each element.
+    EXPECT_EQ(acb.consume_up_to(2, [&count](auto) { ++count; }), 2u);
+    EXPECT_EQ(count, 2u);
+
+    acb.add(4).add(5).add(6);
+
+    EXPECT_EQ(acb.consume_all([&sum](const auto& value) { sum += value; }), 4u);
+    EXPECT_EQ(sum, 18);
+
+    acb.add(7).add(8).add(9);
+    count = 0;
+
+    EXPECT_EQ(acb.consume_segments_up_to(2, [&count](auto values)
+    {
+        count += values.size();
+    }), 2u);
+    EXPECT_EQ(count, 2u);
+    EXPECT_EQ(acb.get(), 9);
+}
+
+template <typename T>
+void array_nan_extremum(size_t nan_index)
+{
+    array_circular_buffer<T> acb(43);
+
+    for (size_t n = 0; n < acb.buffer_size(); ++n)
+    {
+        acb.add(n == nan_index ? std::numeric_limits<T>::quiet_NaN()
+                               : static_cast<T>(n));
+    }
+
+    EXPECT_TRUE(std::isnan(acb.min())) << nan_index;
+    EXPECT_TRUE(std::isnan(acb.max())) << nan_index;
+}
+
+TEST(array_circular_buffer, test_22)
+{
+    // 43 values : the NaN is first, in the vectorized body or in the tail.
+    for (size_t nan_index : { 0, 5, 41 })
+    {
+        array_nan_extremum<double>(nan_index);
+        array_nan_extremum<float>(nan_index);
+    }
+
+    array_circular_buffer<double> acb(43);
+
+    for (int n = 0; n < 43; ++n)
+    {
+        acb.add(n);
+    }
+
+    EXPECT_EQ(acb.min(), 0.0);
+    EXPECT_EQ(acb.max(), 42.0);
+}
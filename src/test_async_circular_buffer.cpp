@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "async_circular_buffer.hpp"
+
+namespace
+{
+    using task = circular_buffer_executor::task;
+
+    task produce(async_circular_buffer<int>& buffer, int first, int count)
+    {
+        for (int n = first; n < first + count; ++n)
+        {
+            co_await buffer.async_add(n);
+        }
+    }
+
+    task consume(async_circular_buffer<int>& buffer, int count,
+                 std::vector<int>& values)
+    {
+        for (int n = 0; n < count; ++n)
+        {
+            values.push_back(co_await buffer.async_get());
+        }
+    }
+
+    using string_buffer = async_circular_buffer<std::unique_ptr<std::string>>;
+
+    task receive(string_buffer& buffer, circular_buffer_executor& executor,
+                 int count, std::string& received)
+    {
+        for (int n = 0; n < count; ++n)
+        {
+            received += *co_await buffer.async_get();
+            co_await executor.yield();
+        }
+    }
+
+    task send(string_buffer& buffer, std::string value)
+    {
+        co_await buffer.async_add(std::make_unique<std::string>(value));
+    }
+}
+
+TEST(async_circular_buffer, test_1)
+{
+    circular_buffer_executor executor;
+    async_circular_buffer<int> acb(4);
+    std::vector<int> values;
+
+    EXPECT_EQ(acb.buffer_size(), 4u);
+    EXPECT_TRUE(acb.is_empty());
+
+    executor.spawn(consume(acb, 100, values));
+    executor.spawn(produce(acb, 0, 100));
+
+    // Each coroutine only starts once : every other resumption is inline.
+    EXPECT_EQ(executor.run(), 2u);
+    ASSERT_EQ(values.size(), 100u);
+
+    for (int n = 0; n < 100; ++n)
+    {
+        EXPECT_EQ(values[n], n);
+    }
+
+    EXPECT_TRUE(acb.is_empty());
+
+
+    // The producer fills the buffer and suspends, the consumer then drains
+    // it and resumes the producer each time a slot is released.
+    values.clear();
+    executor.spawn(produce(acb, 0, 10));
+    executor.spawn(consume(acb, 10, values));
+    executor.run();
+
+    EXPECT_EQ(values.size(), 10u);
+    EXPECT_EQ(values.back(), 9);
+}
+
+TEST(async_circular_buffer, test_2)
+{
+    circular_buffer_executor executor;
+    async_circular_buffer<std::unique_ptr<std::string>> acb(0);
+    std::string received;
+    std::unique_ptr<std::string> value;
+
+    executor.spawn(receive(acb, executor, 3, received));
+    executor.run();
+
+    EXPECT_TRUE(received.empty());
+    EXPECT_TRUE(acb.try_add(std::make_unique<std::string>("titi")));
+    EXPECT_EQ(received, "titi");
+
+    // The receiver is now queued on the executor : nobody is waiting.
+    EXPECT_FALSE(acb.try_add(std::make_unique<std::string>("toto")));
+    EXPECT_FALSE(acb.try_get(value));
+
+    executor.spawn(send(acb, "tutu"));
+    executor.run();
+
+    EXPECT_EQ(received, "tititutu");
+    EXPECT_TRUE(acb.try_add(std::make_unique<std::string>("tata")));
+    EXPECT_EQ(received, "tititututata");
+
+    executor.run();
+    executor.spawn(send(acb, "toto"));
+    executor.run();
+
+    EXPECT_TRUE(acb.try_get(value));
+    EXPECT_EQ(*value, "toto");
+    EXPECT_FALSE(acb.try_get(value));
+}
+
+TEST(async_circular_buffer, test_3)
+{
+    circular_buffer_executor executor;
+    async_circular_buffer<int> acb(2);
+    std::vector<std::vector<int>> values(3);
+    int total = 0;
+
+    for (auto& consumed : values)
+    {
+        executor.spawn(consume(acb, 20, consumed));
+    }
+
+    executor.spawn(produce(acb, 0, 30));
+    executor.spawn(produce(acb, 100, 30));
+    executor.run();
+
+    for (auto& consumed : values)
+    {
+        EXPECT_EQ(consumed.size(), 20u);
+
+        for (int value : consumed)
+        {
+            total += value;
+        }
+    }
+
+    EXPECT_EQ(total, 435 + 3435);
+    EXPECT_TRUE(acb.is_empty());
+}
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+
+#include <shared_mutex>
+#include <string>
+
+#include "fixed_circular_buffer.hpp"
+
+TEST(fixed_circular_buffer, test_1)
+{
+    fixed_circular_buffer<int, 4> fcb;
+
+    static_assert(fixed_circular_buffer<int, 4>::buffer_size() == 4);
+
+    EXPECT_EQ(fcb.buffer_size(), 4u);
+    EXPECT_TRUE(fcb.is_empty());
+    EXPECT_FALSE(fcb.is_full());
+
+    try
+    {
+        fcb.get();
+        FAIL() << "expected std::out_of_range";
+    }
+    catch (const std::out_of_range& e)
+    {
+        EXPECT_EQ(e.what(), std::string("circular buffer is empty"));
+    }
+
+    {
+        int i = 42;
+
+        EXPECT_FALSE(fcb.try_get(i));
+        EXPECT_EQ(i, 42);
+    }
+
+
+    fcb.add(1).add(2).add(3).add(4).add(5).add(6);
+
+    EXPECT_FALSE(fcb.is_empty());
+    EXPECT_TRUE(fcb.is_full());
+    EXPECT_EQ(fcb.get(), 3);
+    EXPECT_EQ(fcb.get(), 4);
+    EXPECT_EQ(fcb.get(), 5);
+
+
+    fcb.add(7).add(8).add(9);
+
+    EXPECT_TRUE(fcb.is_full());
+    EXPECT_EQ(fcb.get(), 6);
+    EXPECT_EQ(fcb.get(), 7);
+
+
+    fcb.clear();
+
+    EXPECT_TRUE(fcb.is_empty());
+    EXPECT_FALSE(fcb.is_full());
+}
+
+TEST(fixed_circular_buffer, test_2)
+{
+    using namespace std::literals::string_literals;
+
+    fixed_circular_buffer<std::string, 3> fcb;
+    auto tutu = "tutu"s;
+
+    fcb.add("titi").add("toto").add(tutu).add("tata");
+
+    EXPECT_TRUE(fcb.is_full());
+
+
+    fixed_circular_buffer<std::string, 3> fcb2 = fcb;
+
+    EXPECT_TRUE(fcb2.is_full());
+    EXPECT_EQ(fcb2.get(), std::string("toto"));
+    EXPECT_EQ(fcb2.get(), std::string("tutu"));
+
+
+    fixed_circular_buffer<std::string, 3> fcb3 = std::move(fcb);
+
+    EXPECT_TRUE(fcb.is_empty());
+    EXPECT_TRUE(fcb3.is_full());
+    EXPECT_EQ(fcb3.get(), std::string("toto"));
+    EXPECT_EQ(fcb3.get(), std::string("tutu"));
+    EXPECT_EQ(fcb3.get(), std::string("tata"));
+
+
+    std::string value;
+
+    EXPECT_FALSE(fcb3.try_get(value));
+
+    fcb2 = fcb3;
+
+    EXPECT_TRUE(fcb2.is_empty());
+
+    fcb3.add("teatea");
+    fcb2 = std::move(fcb3);
+
+    EXPECT_TRUE(fcb2.try_get(value));
+    EXPECT_EQ(value, std::string("teatea"));
+    EXPECT_TRUE(fcb3.is_empty());
+}
+
+TEST(fixed_circular_buffer, test_3)
+{
+    fixed_circular_buffer<int, 3, null_lock> fcb;
+
+    fcb.add(1).add(2).add(3).add(4);
+
+    EXPECT_TRUE(fcb.is_full());
+    EXPECT_EQ(fcb.get(), 2);
+
+
+    fixed_circular_buffer<int, 3, std::shared_mutex> fcb2;
+
+    fcb2.add(5);
+
+    auto fcb3 = fcb2;
+
+    EXPECT_FALSE(fcb3.is_empty());
+    EXPECT_EQ(fcb3.get(), 5);
+}
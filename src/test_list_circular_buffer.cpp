@@ -1,5 +1,13 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <shared_mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
 #include "list_circular_buffer.hpp"
 
 TEST(list_circular_buffer, test_1)
@@ -344,3 +352,352 @@ TEST(list_circular_buffer, test_4)
     EXPECT_EQ(lcb2.get(), std::string("turtur"));
     EXPECT_EQ(lcb2.get(), std::string("terter"));
 }
+
+TEST(list_circular_buffer, test_5)
+{
+    using namespace std::chrono_literals;
+
+    list_circular_buffer<int> lcb(2);
+    int value = 42;
+
+    EXPECT_FALSE(lcb.wait_get_for(value, 10ms));
+    EXPECT_EQ(value, 42);
+
+
+    std::thread producer([&lcb]()
+    {
+        std::this_thread::sleep_for(20ms);
+        lcb.add(1).add(2);
+    });
+
+    EXPECT_EQ(lcb.wait_get(), 1);
+    EXPECT_TRUE(lcb.wait_get_for(value, 1s));
+    EXPECT_EQ(value, 2);
+
+    producer.join();
+
+
+    lcb.add(3).add(4);
+
+    std::thread consumer([&lcb]()
+    {
+        std::this_thread::sleep_for(20ms);
+        EXPECT_EQ(lcb.get(), 3);
+    });
+
+    lcb.wait_add(5);
+
+    consumer.join();
+
+    EXPECT_TRUE(lcb.is_full());
+    EXPECT_EQ(lcb.get(), 4);
+    EXPECT_EQ(lcb.get(), 5);
+    EXPECT_TRUE(lcb.is_empty());
+}
+
+TEST(list_circular_buffer, test_6)
+{
+    list_circular_buffer<int, full_policy::reject> lcb(2);
+
+    EXPECT_TRUE(lcb.try_add(1));
+    lcb.add(2);
+
+    EXPECT_TRUE(lcb.is_full());
+    EXPECT_FALSE(lcb.try_add(3));
+
+    try
+    {
+        lcb.add(3);
+        FAIL() << "expected std::out_of_range";
+    }
+    catch (const std::out_of_range& e)
+    {
+        EXPECT_EQ(e.what(), std::string("circular buffer is full"));
+    }
+
+    EXPECT_EQ(lcb.get(), 1);
+    EXPECT_TRUE(lcb.try_add(3));
+    EXPECT_EQ(lcb.get(), 2);
+    EXPECT_EQ(lcb.get(), 3);
+
+
+    lcb.add(4).add(5);
+    lcb.resize(1);
+
+    EXPECT_TRUE(lcb.is_full());
+    EXPECT_EQ(lcb.get(), 5);
+
+
+    using namespace std::chrono_literals;
+
+    list_circular_buffer<int, full_policy::block> lcb2(2);
+
+    lcb2.add(1).add(2);
+
+    EXPECT_FALSE(lcb2.try_add(3));
+
+    std::thread consumer([&lcb2]()
+    {
+        std::this_thread::sleep_for(20ms);
+        EXPECT_EQ(lcb2.get(), 1);
+    });
+
+    lcb2.add(3);
+
+    consumer.join();
+
+    EXPECT_EQ(lcb2.get(), 2);
+    EXPECT_EQ(lcb2.get(), 3);
+
+
+    list_circular_buffer<int> lcb3(2);
+
+    EXPECT_TRUE(lcb3.try_add(1));
+    EXPECT_TRUE(lcb3.try_add(2));
+    EXPECT_TRUE(lcb3.try_add(3));
+    EXPECT_EQ(lcb3.get(), 2);
+    EXPECT_EQ(lcb3.get(), 3);
+}
+
+template <typename Lock>
+static void list_lock_policy()
+{
+    list_circular_buffer<int, full_policy::overwrite, Lock> lcb(3);
+
+    lcb.add(1).add(2).add(3).add(4);
+
+    EXPECT_EQ(lcb.buffer_size(), 3u);
+    EXPECT_TRUE(lcb.is_full());
+    EXPECT_EQ(lcb.get(), 2);
+
+
+    auto lcb2 = lcb;
+
+    lcb2 = lcb;
+    lcb2 = std::move(lcb);
+    lcb2.resize(1);
+
+    EXPECT_EQ(lcb2.get(), 4);
+    EXPECT_TRUE(lcb2.is_empty());
+}
+
+TEST(list_circular_buffer, test_7)
+{
+    list_lock_policy<null_lock>();
+    list_lock_policy<spin_lock>();
+    list_lock_policy<std::mutex>();
+    list_lock_policy<std::recursive_mutex>();
+    list_lock_policy<std::shared_mutex>();
+
+    // Buffers that can't block carry no condition variable.
+    using unlocked = list_circular_buffer<int, full_policy::overwrite, null_lock>;
+    using locked = list_circular_buffer<int, full_policy::overwrite, spin_lock>;
+
+    EXPECT_TRUE(std::is_empty_v<circular_buffer_waiters<null_lock>>);
+    EXPECT_LT(sizeof(unlocked), sizeof(locked));
+
+
+    list_circular_buffer<int, full_policy::reject, spin_lock> lcb(16);
+    std::thread producer([&lcb]()
+    {
+        for (int n = 0; n < 10000; ++n)
+        {
+            while (!lcb.try_add(n))
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    int value;
+
+    for (int n = 0; n < 10000; ++n)
+    {
+        while (!lcb.try_get(value))
+        {
+            std::this_thread::yield();
+        }
+
+        EXPECT_EQ(value, n);
+    }
+
+    producer.join();
+}
+
+TEST(list_circular_buffer, test_8)
+{
+    list_circular_buffer<int> lcb(5);
+
+    lcb.add(1).add(2).add(3).add(4).add(5).add(6).add(7);
+    lcb.resize(8);
+
+    EXPECT_FALSE(lcb.is_full());
+
+    lcb.add(8).add(9).add(10);
+
+    EXPECT_TRUE(lcb.is_full());
+
+    lcb.resize(3);
+
+    EXPECT_TRUE(lcb.is_full());
+    EXPECT_EQ(lcb.get(), 8);
+    EXPECT_EQ(lcb.get(), 9);
+    EXPECT_EQ(lcb.get(), 10);
+    EXPECT_TRUE(lcb.is_empty());
+
+
+    using namespace std::literals::string_literals;
+
+    list_circular_buffer<std::string> lcb2(3);
+
+    lcb2.add("titi").add("toto").add("tutu").add("tata");
+
+    EXPECT_EQ(lcb2.get(), "toto"s);
+
+    lcb2.add("tete");
+    lcb2.resize(6);
+    lcb2.add("tartar");
+
+    EXPECT_FALSE(lcb2.is_full());
+    EXPECT_EQ(lcb2.get(), "tutu"s);
+
+    lcb2.resize(2);
+
+    EXPECT_TRUE(lcb2.is_full());
+    EXPECT_EQ(lcb2.get(), "tete"s);
+    EXPECT_EQ(lcb2.get(), "tartar"s);
+}
+
+TEST(list_circular_buffer, test_9)
+{
+    list_circular_buffer<int> lcb(4);
+
+    EXPECT_EQ(lcb.size(), 0u);
+    EXPECT_TRUE(lcb.begin() == lcb.end());
+
+    try
+    {
+        lcb.back();
+        FAIL() << "expected std::out_of_range";
+    }
+    catch (const std::out_of_range& e)
+    {
+        EXPECT_EQ(e.what(), std::string("circular buffer is empty"));
+    }
+
+    lcb.add(1).add(2).add(3).add(4).add(5).add(6);
+
+    EXPECT_EQ(lcb.size(), 4u);
+    EXPECT_EQ(lcb[0], 3);
+    EXPECT_EQ(lcb[3], 6);
+    EXPECT_EQ(lcb.at(2), 5);
+    EXPECT_EQ(lcb.front(), 3);
+    EXPECT_EQ(lcb.back(), 6);
+
+    try
+    {
+        lcb.at(4);
+        FAIL() << "expected std::out_of_range";
+    }
+    catch (const std::out_of_range& e)
+    {
+        EXPECT_EQ(e.what(), std::string("circular buffer index out of range"));
+    }
+
+    EXPECT_EQ(std::distance(lcb.begin(), lcb.end()), 4);
+    EXPECT_EQ(std::vector<int>(lcb.begin(), lcb.end()),
+              std::vector<int>({ 3, 4, 5, 6 }));
+
+    for (int& value : lcb)
+    {
+        value *= 10;
+    }
+
+    const auto& clcb = lcb;
+    list_circular_buffer<int>::const_iterator it = lcb.begin();
+
+    EXPECT_TRUE(it == clcb.cbegin());
+    EXPECT_EQ(*std::find(clcb.begin(), clcb.end(), 50), 50);
+    EXPECT_EQ(lcb.get(), 30);
+    EXPECT_EQ(clcb.front(), 40);
+    EXPECT_EQ(lcb.size(), 3u);
+}
+
+TEST(list_circular_buffer, test_10)
+{
+    list_circular_buffer<int, full_policy::overwrite, std::mutex,
+                         counting_stats> lcb(3);
+    int value;
+
+    EXPECT_FALSE(lcb.try_get(value));
+
+    lcb.add(1).add(2).add(3).add(4).add(5);
+
+    EXPECT_EQ(lcb.get(), 3);
+    EXPECT_TRUE(lcb.try_get(value));
+
+    auto stats = lcb.snapshot();
+
+    EXPECT_EQ(stats.adds, 5u);
+    EXPECT_EQ(stats.gets, 2u);
+    EXPECT_EQ(stats.overwritten, 2u);
+    EXPECT_EQ(stats.try_get_empty, 1u);
+    EXPECT_EQ(stats.try_get_contended, 0u);
+    EXPECT_EQ(stats.peak_size, 3u);
+}
+
+TEST(list_circular_buffer, test_11)
+{
+    list_circular_buffer<int> lcb(4);
+    std::vector<int> seen;
+    auto collect = [&seen](int value) { seen.push_back(value); };
+
+    EXPECT_EQ(lcb.consume_all(collect), 0u);
+
+    lcb.add(1).add(2).add(3).add(4).add(5);
+
+    EXPECT_EQ(lcb.consume_up_to(3, collect), 3u);
+    EXPECT_EQ(seen, std::vector<int>({ 2, 3, 4 }));
+    EXPECT_FALSE(lcb.is_full());
+
+    lcb.add(6).add(7).add(8);
+
+    EXPECT_TRUE(lcb.is_full());
+    EXPECT_EQ(lcb.consume_all(collect), 4u);
+    EXPECT_EQ(seen, std::vector<int>({ 2, 3, 4, 5, 6, 7, 8 }));
+    EXPECT_TRUE(lcb.is_empty());
+}
+
+TEST(list_circular_buffer, test_12)
+{
+    using namespace std::chrono_literals;
+
+    list_circular_buffer<int, full_policy::block> lcb(1);
+
+    lcb.add(1);
+
+    std::thread producer([&lcb]()
+    {
+        EXPECT_THROW(lcb.add(2), std::out_of_range);
+    });
+
+    std::this_thread::sleep_for(20ms);
+    lcb.resize(0);
+    producer.join();
+
+
+    lcb.resize(1);
+    lcb.add(3);
+
+    std::thread waiter([&lcb]()
+    {
+        EXPECT_THROW(lcb.wait_add(4), std::out_of_range);
+    });
+
+    std::this_thread::sleep_for(20ms);
+    lcb.resize(0);
+    waiter.join();
+
+    EXPECT_EQ(lcb.buffer_size(), 0u);
+    EXPECT_TRUE(lcb.is_empty());
+}
@@ -0,0 +1,183 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <system_error>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "mapped_circular_buffer.hpp"
+
+namespace
+{
+    std::string mapped_path(const char* name)
+    {
+        return std::string("/tmp/") + name + "_" + std::to_string(getpid());
+    }
+}
+
+TEST(mapped_circular_buffer, test_1)
+{
+    const std::string path = mapped_path("mapped_circular_buffer_1");
+
+    std::remove(path.c_str());
+
+    try
+    {
+        mapped_circular_buffer<int> mcb(path);
+        FAIL() << "expected std::system_error";
+    }
+    catch (const std::system_error&)
+    {
+    }
+
+    mapped_circular_buffer<int> mcb(path, 3);
+
+    EXPECT_EQ(mcb.buffer_size(), 3u);
+    EXPECT_TRUE(mcb.is_empty());
+
+    try
+    {
+        mcb.get();
+        FAIL() << "expected std::out_of_range";
+    }
+    catch (const std::out_of_range& e)
+    {
+        EXPECT_EQ(e.what(), std::string("circular buffer is empty"));
+    }
+
+    mcb.add(1).add(2).add(3).add(4);
+
+    EXPECT_TRUE(mcb.is_full());
+    EXPECT_EQ(mcb.get(), 2);
+
+    int value;
+
+    EXPECT_TRUE(mcb.try_get(value));
+    EXPECT_EQ(value, 3);
+    EXPECT_EQ(mcb.size(), 1u);
+
+    mcb.clear();
+
+    EXPECT_TRUE(mcb.is_empty());
+    EXPECT_FALSE(mcb.try_get(value));
+
+    std::remove(path.c_str());
+}
+
+TEST(mapped_circular_buffer, test_2)
+{
+    const std::string path = mapped_path("mapped_circular_buffer_2");
+
+    std::remove(path.c_str());
+
+    {
+        mapped_circular_buffer<double> mcb(path, 4);
+
+        for (int n = 0; n < 6; ++n)
+        {
+            mcb.add(n * 0.5);
+        }
+
+        mcb.sync();
+    }
+
+    mapped_circular_buffer<double> mcb(path, 100);
+
+    EXPECT_EQ(mcb.buffer_size(), 4u);
+    EXPECT_EQ(mcb.size(), 4u);
+    EXPECT_EQ(mcb.get(), 1.0);
+
+    mapped_circular_buffer<double> mcb2 = std::move(mcb);
+
+    EXPECT_EQ(mcb.buffer_size(), 0u);
+    EXPECT_EQ(mcb2.get(), 1.5);
+
+    try
+    {
+        mapped_circular_buffer<char> mcb3(path);
+        FAIL() << "expected std::runtime_error";
+    }
+    catch (const std::runtime_error& e)
+    {
+        EXPECT_EQ(e.what(), std::string("invalid circular buffer file"));
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST(mapped_circular_buffer, test_3)
+{
+    const std::string path = mapped_path("mapped_circular_buffer_3");
+
+    {
+        std::ofstream file(path, std::ios::trunc);
+
+        file << "not a circular buffer\n";
+    }
+
+    try
+    {
+        mapped_circular_buffer<int> mcb(path, 4);
+        FAIL() << "expected std::runtime_error";
+    }
+    catch (const std::runtime_error& e)
+    {
+        EXPECT_EQ(e.what(), std::string("invalid circular buffer file"));
+    }
+
+    std::ifstream file(path);
+    std::stringstream content;
+
+    content << file.rdbuf();
+
+    EXPECT_EQ(content.str(), std::string("not a circular buffer\n"));
+
+    std::ofstream(path, std::ios::trunc).close();
+
+    mapped_circular_buffer<int> mcb(path, 4);
+
+    EXPECT_EQ(mcb.buffer_size(), 4u);
+    EXPECT_TRUE(mcb.is_empty());
+
+    std::remove(path.c_str());
+}
+
+TEST(mapped_circular_buffer, test_4)
+{
+    const std::string path = mapped_path("mapped_circular_buffer_4");
+
+    std::remove(path.c_str());
+
+    {
+        mapped_circular_buffer<int> mcb(path, 4);
+
+        mcb.add(1).add(2);
+    }
+
+    // The capacity, third field of the header, is large enough for its size
+    // in bytes to wrap around.
+    const int fd = open(path.c_str(), O_RDWR);
+    const uint64_t buffer_size = uint64_t(1) << 62;
+
+    ASSERT_NE(fd, -1);
+    ASSERT_EQ(pwrite(fd, &buffer_size, sizeof(buffer_size), 16),
+              sizeof(buffer_size));
+    close(fd);
+
+    try
+    {
+        mapped_circular_buffer<int> mcb(path, 4);
+        FAIL() << "expected std::runtime_error";
+    }
+    catch (const std::runtime_error& e)
+    {
+        EXPECT_EQ(e.what(), std::string("invalid circular buffer file"));
+    }
+
+    std::remove(path.c_str());
+}
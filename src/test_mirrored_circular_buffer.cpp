@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+
+#include <unistd.h>
+
+#include "mirrored_circular_buffer.hpp"
+
+TEST(mirrored_circular_buffer, test_1)
+{
+    mirrored_circular_buffer<> mcb;
+
+    EXPECT_EQ(mcb.buffer_size(), 0u);
+    EXPECT_TRUE(mcb.is_empty());
+    EXPECT_FALSE(mcb.is_full());
+
+    try
+    {
+        mcb.add('a');
+        FAIL() << "expected std::out_of_range";
+    }
+    catch (const std::out_of_range& e)
+    {
+        EXPECT_EQ(
+            e.what(),
+            std::string("circular buffer doesn't have space memory to store"));
+    }
+
+    try
+    {
+        mcb.get();
+        FAIL() << "expected std::out_of_range";
+    }
+    catch (const std::out_of_range& e)
+    {
+        EXPECT_EQ(e.what(), std::string("circular buffer is empty"));
+    }
+}
+
+TEST(mirrored_circular_buffer, test_2)
+{
+    const size_t page_size = sysconf(_SC_PAGESIZE);
+    mirrored_circular_buffer<> mcb(1);
+
+    EXPECT_EQ(mcb.buffer_size(), page_size);
+
+
+    std::string data(page_size - 3, 'x');
+
+    mcb.add(data);
+
+    EXPECT_EQ(mcb.get(data), page_size - 3);
+    EXPECT_TRUE(mcb.is_empty());
+
+
+    mcb.add(std::string("titi toto"));
+
+    auto window = mcb.peek();
+
+    EXPECT_EQ(std::string(window.begin(), window.end()), "titi toto");
+
+    mcb.consume(5);
+
+    EXPECT_EQ(mcb.get(), 't');
+    EXPECT_EQ(mcb.size(), 3u);
+
+
+    auto writable = mcb.prepare(page_size);
+
+    EXPECT_EQ(writable.size(), page_size - 3);
+
+    std::memset(writable.data(), 'y', writable.size());
+    mcb.commit(writable.size());
+
+    EXPECT_TRUE(mcb.is_full());
+
+    mcb.add('z');
+
+    window = mcb.peek();
+
+    EXPECT_EQ(window.size(), page_size);
+    EXPECT_EQ(window.front(), 't');
+    EXPECT_EQ(window[2], 'y');
+    EXPECT_EQ(window.back(), 'z');
+
+    char value;
+
+    EXPECT_TRUE(mcb.try_get(value));
+    EXPECT_EQ(value, 't');
+
+
+    mirrored_circular_buffer<> mcb2 = std::move(mcb);
+
+    EXPECT_EQ(mcb.buffer_size(), 0u);
+    EXPECT_EQ(mcb2.size(), page_size - 1);
+
+    mcb2.clear();
+
+    EXPECT_TRUE(mcb2.is_empty());
+}
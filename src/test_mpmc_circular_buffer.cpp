@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mpmc_circular_buffer.hpp"
+
+TEST(mpmc_circular_buffer, test_1)
+{
+    mpmc_circular_buffer<int> mcb;
+
+    EXPECT_EQ(mcb.buffer_size(), 0u);
+    EXPECT_TRUE(mcb.is_empty());
+    EXPECT_TRUE(mcb.is_full());
+    EXPECT_FALSE(mcb.try_add(42));
+
+    try
+    {
+        mcb.add(42);
+        FAIL() << "expected std::out_of_range";
+    }
+    catch (const std::out_of_range& e)
+    {
+        EXPECT_EQ(
+            e.what(),
+            std::string("circular buffer doesn't have space memory to store"));
+    }
+
+    try
+    {
+        mcb.get();
+        FAIL() << "expected std::out_of_range";
+    }
+    catch (const std::out_of_range& e)
+    {
+        EXPECT_EQ(e.what(), std::string("circular buffer is empty"));
+    }
+}
+
+TEST(mpmc_circular_buffer, test_2)
+{
+    mpmc_circular_buffer<int> mcb(1);
+    int value = 0;
+
+    EXPECT_EQ(mcb.buffer_size(), 1u);
+    EXPECT_TRUE(mcb.try_add(1));
+    EXPECT_TRUE(mcb.is_full());
+    EXPECT_FALSE(mcb.try_add(2));
+    EXPECT_TRUE(mcb.try_get(value));
+    EXPECT_EQ(value, 1);
+    EXPECT_FALSE(mcb.try_get(value));
+
+    for (int n = 2; n < 10; ++n)
+    {
+        EXPECT_TRUE(mcb.try_add(n));
+        EXPECT_FALSE(mcb.try_add(n + 100));
+        EXPECT_EQ(mcb.get(), n);
+        EXPECT_TRUE(mcb.is_empty());
+    }
+}
+
+TEST(mpmc_circular_buffer, test_3)
+{
+    mpmc_circular_buffer<std::string> mcb(3);
+
+    EXPECT_EQ(mcb.buffer_size(), 3u);
+    EXPECT_TRUE(mcb.is_empty());
+    EXPECT_FALSE(mcb.is_full());
+
+    mcb.add("titi").add("toto").add("tutu");
+
+    EXPECT_FALSE(mcb.is_empty());
+    EXPECT_TRUE(mcb.is_full());
+    EXPECT_FALSE(mcb.try_add("tata"));
+
+    try
+    {
+        mcb.add("tata");
+        FAIL() << "expected std::out_of_range";
+    }
+    catch (const std::out_of_range& e)
+    {
+        EXPECT_EQ(e.what(), std::string("circular buffer is full"));
+    }
+
+    EXPECT_EQ(mcb.get(), std::string("titi"));
+    EXPECT_TRUE(mcb.try_add("tata"));
+    EXPECT_EQ(mcb.get(), std::string("toto"));
+    EXPECT_EQ(mcb.get(), std::string("tutu"));
+
+    std::string value;
+
+    EXPECT_TRUE(mcb.try_get(value));
+    EXPECT_EQ(value, std::string("tata"));
+    EXPECT_FALSE(mcb.try_get(value));
+    EXPECT_TRUE(mcb.is_empty());
+}
+
+TEST(mpmc_circular_buffer, test_4)
+{
+    constexpr int producers = 4;
+    constexpr int consumers = 4;
+    constexpr int count = 20000;
+    mpmc_circular_buffer<int> mcb(100);
+    std::atomic<long> sum(0);
+    std::atomic<int> received(0);
+    std::vector<std::thread> threads;
+
+    for (int p = 0; p < producers; ++p)
+    {
+        threads.emplace_back([&mcb]()
+        {
+            for (int n = 1; n <= count; ++n)
+            {
+                while (!mcb.try_add(n))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    for (int c = 0; c < consumers; ++c)
+    {
+        threads.emplace_back([&]()
+        {
+            int value;
+
+            while (received.load() < producers * count)
+            {
+                if (mcb.try_get(value))
+                {
+                    sum += value;
+                    ++received;
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    EXPECT_EQ(sum.load(),
+              static_cast<long>(producers) * count * (count + 1) / 2);
+    EXPECT_TRUE(mcb.is_empty());
+}
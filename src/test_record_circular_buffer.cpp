@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "record_circular_buffer.hpp"
+
+namespace
+{
+    std::span<const std::byte> bytes(std::string_view s)
+    {
+        return std::as_bytes(std::span<const char>(s.data(), s.size()));
+    }
+
+    std::string text(std::span<std::byte> record)
+    {
+        return std::string(reinterpret_cast<const char*>(record.data()),
+                           record.size());
+    }
+}
+
+TEST(record_circular_buffer, test_1)
+{
+    record_circular_buffer<> rcb;
+
+    EXPECT_EQ(rcb.buffer_size(), 0u);
+    EXPECT_TRUE(rcb.is_empty());
+    EXPECT_FALSE(rcb.peek());
+    EXPECT_FALSE(rcb.try_add(bytes("titi")));
+    EXPECT_FALSE(rcb.try_add({ }));
+
+    try
+    {
+        rcb.reserve(0);
+        FAIL() << "expected std::out_of_range";
+    }
+    catch (const std::out_of_range& e)
+    {
+        EXPECT_EQ(
+            e.what(),
+            std::string("circular buffer doesn't have space memory to store"));
+    }
+
+    try
+    {
+        rcb.add(bytes("titi"));
+        FAIL() << "expected std::out_of_range";
+    }
+    catch (const std::out_of_range& e)
+    {
+        EXPECT_EQ(
+            e.what(),
+            std::string("circular buffer doesn't have space memory to store"));
+    }
+
+    try
+    {
+        rcb.pop();
+        FAIL() << "expected std::out_of_range";
+    }
+    catch (const std::out_of_range& e)
+    {
+        EXPECT_EQ(e.what(), std::string("circular buffer is empty"));
+    }
+}
+
+TEST(record_circular_buffer, test_2)
+{
+    // A record takes its size plus an 8 bytes header, rounded up to 8.
+    record_circular_buffer<> rcb(60);
+
+    EXPECT_EQ(rcb.buffer_size(), 64u);
+
+    // [0, 16) [16, 24) [24, 56)
+    rcb.add(bytes("titi")).add(bytes("")).add(bytes("a record of 20 bytes"));
+
+    EXPECT_EQ(rcb.size(), 3u);
+    EXPECT_FALSE(rcb.try_add(bytes("toto")));
+
+    try
+    {
+        rcb.add(bytes("toto"));
+        FAIL() << "expected std::out_of_range";
+    }
+    catch (const std::out_of_range& e)
+    {
+        EXPECT_EQ(e.what(),
+                  std::string("circular buffer doesn't have enough space"));
+    }
+
+    EXPECT_EQ(text(*rcb.peek()), "titi");
+    rcb.pop();
+    EXPECT_EQ(text(*rcb.peek()), "");
+    rcb.pop();
+
+    // Only 8 bytes are left at the end : they are skipped and the record
+    // goes to [0, 16).
+    auto record = rcb.reserve(7);
+
+    EXPECT_EQ(record.size(), 7u);
+
+    std::memcpy(record.data(), "tutu!!!", 7);
+    rcb.commit(4);
+
+    EXPECT_EQ(text(*rcb.peek()), "a record of 20 bytes");
+    rcb.pop();
+    EXPECT_EQ(text(*rcb.peek()), "tutu");
+
+    // [16, 56), leaving 8 bytes at the end and none at the start.
+    rcb.add(bytes(std::string(30, 'x')));
+
+    EXPECT_FALSE(rcb.try_add(bytes("tata")));
+
+    rcb.pop();
+    rcb.add(bytes("tata"));
+
+    EXPECT_EQ(text(*rcb.peek()), std::string(30, 'x'));
+    rcb.pop();
+    EXPECT_EQ(text(*rcb.peek()), "tata");
+    rcb.pop();
+    EXPECT_TRUE(rcb.is_empty());
+
+    // An empty buffer starts over : the whole arena is available.
+    rcb.add(bytes(std::string(56, 'z')));
+
+    EXPECT_EQ(rcb.peek()->size(), 56u);
+    EXPECT_FALSE(rcb.try_add(bytes("")));
+
+    try
+    {
+        rcb.commit(0);
+        FAIL() << "expected std::out_of_range";
+    }
+    catch (const std::out_of_range& e)
+    {
+        EXPECT_EQ(e.what(),
+                  std::string("circular buffer doesn't have enough space"));
+    }
+
+    rcb.clear();
+
+    EXPECT_TRUE(rcb.is_empty());
+    EXPECT_FALSE(rcb.peek());
+}
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "sharded_circular_buffer.hpp"
+
+TEST(sharded_circular_buffer, test_1)
+{
+    sharded_circular_buffer<int> scb(3, 4);
+
+    EXPECT_EQ(scb.shard_count(), 4u);
+    EXPECT_EQ(scb.buffer_size(), 12u);
+    EXPECT_TRUE(scb.is_empty());
+
+    try
+    {
+        scb.get();
+        FAIL() << "expected std::out_of_range";
+    }
+    catch (const std::out_of_range& e)
+    {
+        EXPECT_EQ(e.what(), std::string("circular buffer is empty"));
+    }
+
+    scb.add(1).add(2).add(3).add(4);
+
+    EXPECT_EQ(scb.size(), 3u);
+    EXPECT_TRUE(scb.local_shard().is_full());
+
+    std::thread other([&scb]()
+    {
+        scb.add(10);
+
+        EXPECT_EQ(scb.local_shard().size(), 1u);
+    });
+
+    other.join();
+
+    EXPECT_EQ(scb.size(), 4u);
+    EXPECT_EQ(scb.get(), 2);
+    EXPECT_EQ(scb.get(), 3);
+    EXPECT_EQ(scb.get(), 4);
+
+    int value;
+
+    EXPECT_TRUE(scb.try_get(value));
+    EXPECT_EQ(value, 10);
+    EXPECT_FALSE(scb.try_get(value));
+
+    scb.add(5);
+    scb.clear();
+
+    EXPECT_TRUE(scb.is_empty());
+}
+
+TEST(sharded_circular_buffer, test_2)
+{
+    constexpr int producers = 4;
+    constexpr int count = 10000;
+    sharded_circular_buffer<int, full_policy::reject> scb(64, producers);
+    std::atomic<long long> total = 0;
+    std::atomic<int> consumed = 0;
+    std::vector<std::thread> threads;
+
+    for (int p = 0; p < producers; ++p)
+    {
+        threads.emplace_back([&scb]()
+        {
+            for (int n = 1; n <= count; ++n)
+            {
+                while (!scb.try_add(n))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    for (int c = 0; c < 2; ++c)
+    {
+        threads.emplace_back([&]()
+        {
+            int value;
+
+            while (consumed.load() < producers * count)
+            {
+                if (scb.try_get(value))
+                {
+                    total += value;
+                    ++consumed;
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    EXPECT_EQ(total.load(), producers * (count * (count + 1LL) / 2));
+    EXPECT_TRUE(scb.is_empty());
+}
@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <system_error>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "shared_circular_buffer.hpp"
+
+namespace
+{
+    std::string shared_name(const char* name)
+    {
+        return std::string("/") + name + "_" + std::to_string(getpid());
+    }
+}
+
+TEST(shared_circular_buffer, test_1)
+{
+    const std::string name = shared_name("shared_circular_buffer_1");
+
+    shared_circular_buffer<int>::remove(name);
+
+    try
+    {
+        shared_circular_buffer<int> scb(name);
+        FAIL() << "expected std::system_error";
+    }
+    catch (const std::system_error&)
+    {
+    }
+
+    shared_circular_buffer<int> producer(name, 3);
+
+    try
+    {
+        shared_circular_buffer<int> scb(name, 3);
+        FAIL() << "expected std::system_error";
+    }
+    catch (const std::system_error&)
+    {
+    }
+
+    shared_circular_buffer<int> consumer(name);
+
+    EXPECT_EQ(consumer.buffer_size(), 3u);
+    EXPECT_TRUE(consumer.is_empty());
+
+    try
+    {
+        consumer.get();
+        FAIL() << "expected std::out_of_range";
+    }
+    catch (const std::out_of_range& e)
+    {
+        EXPECT_EQ(e.what(), std::string("circular buffer is empty"));
+    }
+
+    producer.add(1).add(2).add(3);
+
+    EXPECT_TRUE(consumer.is_full());
+    EXPECT_FALSE(producer.try_add(4));
+
+    try
+    {
+        producer.add(4);
+        FAIL() << "expected std::out_of_range";
+    }
+    catch (const std::out_of_range& e)
+    {
+        EXPECT_EQ(e.what(), std::string("circular buffer is full"));
+    }
+
+    EXPECT_EQ(consumer.get(), 1);
+    EXPECT_TRUE(producer.try_add(4));
+
+    int value;
+
+    EXPECT_TRUE(consumer.try_get(value));
+    EXPECT_EQ(value, 2);
+    EXPECT_EQ(consumer.get(), 3);
+    EXPECT_EQ(consumer.get(), 4);
+    EXPECT_FALSE(consumer.try_get(value));
+
+    try
+    {
+        shared_circular_buffer<char> scb(name);
+        FAIL() << "expected std::runtime_error";
+    }
+    catch (const std::runtime_error& e)
+    {
+        EXPECT_EQ(e.what(), std::string("invalid circular buffer segment"));
+    }
+
+    EXPECT_TRUE(shared_circular_buffer<int>::remove(name));
+    EXPECT_FALSE(shared_circular_buffer<int>::remove(name));
+}
+
+TEST(shared_circular_buffer, test_2)
+{
+    constexpr int count = 100000;
+    const std::string name = shared_name("shared_circular_buffer_2");
+
+    shared_circular_buffer<int>::remove(name);
+
+    shared_circular_buffer<int> consumer(name, 64);
+    const pid_t pid = fork();
+
+    ASSERT_NE(pid, -1);
+
+    if (pid == 0)
+    {
+        shared_circular_buffer<int> producer(name);
+
+        for (int n = 0; n < count; ++n)
+        {
+            while (!producer.try_add(n))
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        _exit(0);
+    }
+
+    int expected = 0;
+    int value;
+
+    while (expected < count)
+    {
+        if (consumer.try_get(value))
+        {
+            EXPECT_EQ(value, expected);
+            ++expected;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    int status;
+
+    EXPECT_EQ(waitpid(pid, &status, 0), pid);
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    EXPECT_TRUE(consumer.is_empty());
+
+    shared_circular_buffer<int>::remove(name);
+}
+
+TEST(shared_circular_buffer, test_3)
+{
+    const std::string name = shared_name("shared_circular_buffer_3");
+
+    shared_circular_buffer<int>::remove(name);
+
+    shared_circular_buffer<int> producer(name, 4);
+
+    producer.add(1);
+
+    // A peer process overwrites the end index, which is on the second cache
+    // line of the segment, with an out of range value.
+    const int fd = shm_open(name.c_str(), O_RDWR, 0);
+    const uint64_t end = 1000;
+
+    ASSERT_NE(fd, -1);
+    ASSERT_EQ(pwrite(fd, &end, sizeof(end), 64), sizeof(end));
+    close(fd);
+
+    try
+    {
+        shared_circular_buffer<int> consumer(name);
+        FAIL() << "expected std::runtime_error";
+    }
+    catch (const std::runtime_error& e)
+    {
+        EXPECT_EQ(e.what(), std::string("invalid circular buffer segment"));
+    }
+
+    EXPECT_THROW(producer.try_add(2), std::runtime_error);
+
+    shared_circular_buffer<int>::remove(name);
+}
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+
+#include "spsc_circular_buffer.hpp"
+
+TEST(spsc_circular_buffer, test_1)
+{
+    spsc_circular_buffer<int> scb;
+
+    EXPECT_EQ(scb.buffer_size(), 0u);
+    EXPECT_TRUE(scb.is_empty());
+    EXPECT_TRUE(scb.is_full());
+    EXPECT_FALSE(scb.try_add(42));
+
+    try
+    {
+        scb.add(42);
+        FAIL() << "expected std::out_of_range";
+    }
+    catch (const std::out_of_range& e)
+    {
+        EXPECT_EQ(
+            e.what(),
+            std::string("circular buffer doesn't have space memory to store"));
+    }
+
+    try
+    {
+        scb.get();
+        FAIL() << "expected std::out_of_range";
+    }
+    catch (const std::out_of_range& e)
+    {
+        EXPECT_EQ(e.what(), std::string("circular buffer is empty"));
+    }
+
+    {
+        int i = 42;
+
+        EXPECT_FALSE(scb.try_get(i));
+        EXPECT_EQ(i, 42);
+    }
+}
+
+TEST(spsc_circular_buffer, test_2)
+{
+    spsc_circular_buffer<std::string> scb(3);
+
+    EXPECT_EQ(scb.buffer_size(), 3u);
+    EXPECT_TRUE(scb.is_empty());
+    EXPECT_FALSE(scb.is_full());
+
+    scb.add("titi").add("toto").add("tutu");
+
+    EXPECT_FALSE(scb.is_empty());
+    EXPECT_TRUE(scb.is_full());
+    EXPECT_FALSE(scb.try_add("tata"));
+
+    try
+    {
+        scb.add("tata");
+        FAIL() << "expected std::out_of_range";
+    }
+    catch (const std::out_of_range& e)
+    {
+        EXPECT_EQ(e.what(), std::string("circular buffer is full"));
+    }
+
+    EXPECT_EQ(scb.get(), std::string("titi"));
+    EXPECT_TRUE(scb.try_add("tata"));
+    EXPECT_EQ(scb.get(), std::string("toto"));
+    EXPECT_EQ(scb.get(), std::string("tutu"));
+
+    std::string value;
+
+    EXPECT_TRUE(scb.try_get(value));
+    EXPECT_EQ(value, std::string("tata"));
+    EXPECT_FALSE(scb.try_get(value));
+    EXPECT_TRUE(scb.is_empty());
+}
+
+TEST(spsc_circular_buffer, test_3)
+{
+    constexpr int count = 100000;
+    spsc_circular_buffer<int> scb(64);
+
+    std::thread producer([&scb]()
+    {
+        for (int n = 0; n < count; ++n)
+        {
+            while (!scb.try_add(n))
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    int expected = 0;
+    int value;
+
+    while (expected < count)
+    {
+        if (scb.try_get(value))
+        {
+            EXPECT_EQ(value, expected);
+            ++expected;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    producer.join();
+
+    EXPECT_TRUE(scb.is_empty());
+}
@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <deque>
+#include <numeric>
+#include <string>
+
+#include "statistics_circular_buffer.hpp"
+
+TEST(statistics_circular_buffer, test_1)
+{
+    statistics_circular_buffer<int> scb(3);
+
+    EXPECT_EQ(scb.buffer_size(), 3u);
+    EXPECT_TRUE(scb.is_empty());
+    EXPECT_EQ(scb.sum(), 0);
+
+    try
+    {
+        scb.mean();
+        FAIL() << "expected std::out_of_range";
+    }
+    catch (const std::out_of_range& e)
+    {
+        EXPECT_EQ(e.what(), std::string("circular buffer is empty"));
+    }
+
+    scb.add(4).add(1).add(7);
+
+    EXPECT_TRUE(scb.is_full());
+    EXPECT_EQ(scb.sum(), 12);
+    EXPECT_EQ(scb.mean(), 4.0);
+    EXPECT_EQ(scb.variance(), 6.0);
+    EXPECT_EQ(scb.min(), 1);
+    EXPECT_EQ(scb.max(), 7);
+
+    scb.add(2);
+
+    EXPECT_EQ(scb.sum(), 10);
+    EXPECT_EQ(scb.min(), 1);
+    EXPECT_EQ(scb.max(), 7);
+
+    EXPECT_EQ(scb.get(), 1);
+    EXPECT_EQ(scb.min(), 2);
+    EXPECT_EQ(scb.max(), 7);
+
+    int value;
+
+    EXPECT_TRUE(scb.try_get(value));
+    EXPECT_EQ(value, 7);
+    EXPECT_EQ(scb.size(), 1u);
+    EXPECT_EQ(scb.min(), 2);
+    EXPECT_EQ(scb.max(), 2);
+    EXPECT_EQ(scb.variance(), 0.0);
+
+    statistics_circular_buffer<int> scb2 = scb;
+
+    scb.clear();
+
+    EXPECT_TRUE(scb.is_empty());
+    EXPECT_EQ(scb.sum(), 0);
+    EXPECT_EQ(scb2.sum(), 2);
+}
+
+TEST(statistics_circular_buffer, test_2)
+{
+    constexpr size_t window = 16;
+    statistics_circular_buffer<double> scb(window);
+    std::deque<double> expected;
+    unsigned seed = 42;
+
+    for (int n = 0; n < 2000; ++n)
+    {
+        seed = seed * 1103515245 + 12345;
+
+        const double value = static_cast<int>(seed >> 16) % 1000 - 500;
+
+        if (n % 7 == 3 && !expected.empty())
+        {
+            EXPECT_EQ(scb.get(), expected.front());
+            expected.pop_front();
+        }
+        else
+        {
+            scb.add(value);
+            expected.push_back(value);
+
+            if (expected.size() > window)
+            {
+                expected.pop_front();
+            }
+        }
+
+        if (expected.empty())
+        {
+            continue;
+        }
+
+        const double sum = std::accumulate(expected.begin(), expected.end(),
+                                           0.0);
+        const double mean = sum / expected.size();
+        double variance = 0;
+
+        for (double v : expected)
+        {
+            variance += (v - mean) * (v - mean);
+        }
+
+        variance /= expected.size();
+
+        EXPECT_DOUBLE_EQ(scb.sum(), sum);
+        EXPECT_DOUBLE_EQ(scb.mean(), mean);
+        EXPECT_NEAR(scb.variance(), variance, 1e-6);
+        EXPECT_EQ(scb.min(),
+                  *std::min_element(expected.begin(), expected.end()));
+        EXPECT_EQ(scb.max(),
+                  *std::max_element(expected.begin(), expected.end()));
+    }
+}
+
+TEST(statistics_circular_buffer, test_3)
+{
+    statistics_circular_buffer<double> scb(2);
+
+    scb.add(1e17).add(1).add(1);
+
+    EXPECT_EQ(scb.sum(), 2.0);
+    EXPECT_EQ(scb.mean(), 1.0);
+    EXPECT_EQ(scb.variance(), 0.0);
+
+
+    statistics_circular_buffer<double> scb2(3);
+
+    scb2.add(1e9 + 1).add(1e9 + 2).add(1e9 + 3);
+
+    EXPECT_DOUBLE_EQ(scb2.mean(), 1e9 + 2);
+    EXPECT_NEAR(scb2.variance(), 2.0 / 3, 1e-9);
+
+    for (int n = 4; n < 100000; ++n)
+    {
+        scb2.add(1e9 + n);
+    }
+
+    EXPECT_DOUBLE_EQ(scb2.sum(), 3e9 + 3 * 99998);
+    EXPECT_NEAR(scb2.variance(), 2.0 / 3, 1e-9);
+
+    scb2.add(-1e9);
+
+    EXPECT_DOUBLE_EQ(scb2.variance(), 8.889777786666e17);
+}